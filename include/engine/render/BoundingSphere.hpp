@@ -16,7 +16,7 @@
 
 #include <glm/mat4x4.hpp>
 #include <glm/vec4.hpp>
-#include <vector>
+#include <span>
 
 #include "engine/render/RenderPipelineManager.hpp"
 
@@ -36,7 +36,7 @@ public:
     BoundingSphere();
     BoundingSphere(const glm::vec4 &_center, float _radius);
     BoundingSphere(const BoundingSphere &sphere, const glm::mat4 &transform);
-    explicit BoundingSphere(const std::vector<glm::vec4> &vertices);
+    explicit BoundingSphere(std::span<const glm::vec4> vertices);
 
     const glm::vec4 &getCenter() const;
     float getRadius() const;
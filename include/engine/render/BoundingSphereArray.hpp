@@ -0,0 +1,61 @@
+/// Copyright 2025 Ana Oliveira, Humberto Gomes, Mariana Rocha, Sara Lopes
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <glm/vec4.hpp>
+#include <span>
+#include <vector>
+
+#include "engine/render/BoundingSphere.hpp"
+
+namespace engine::render {
+
+// Bounding spheres stored as separate arrays of coordinates, so that many of them can be tested
+// against the view frustum at once with SIMD instructions
+class BoundingSphereArray {
+private:
+    // Arrays are padded to a multiple of the number of spheres in an AVX-512 register, with
+    // spheres that are never visible
+    static const size_t padding = 16;
+
+    std::vector<float> centersX, centersY, centersZ, radii;
+    size_t count;
+    bool avx2, avx512;
+
+public:
+    BoundingSphereArray();
+    BoundingSphereArray(const BoundingSphereArray &array) = delete;
+    BoundingSphereArray(BoundingSphereArray &&array) = delete;
+
+    // Previous spheres are lost
+    void resize(size_t _count);
+    size_t size() const;
+
+    BoundingSphere get(size_t index) const;
+    void set(size_t index, const BoundingSphere &sphere);
+
+    // Sets bit i % 64 of visibility[i / 64] if sphere i isn't entirely behind any of the planes
+    void cull(std::span<const glm::vec4, 6> planes, std::vector<uint64_t> &visibility) const;
+    static bool isVisible(const std::vector<uint64_t> &visibility, size_t index);
+
+private:
+    void cullScalar(std::span<const glm::vec4, 6> planes, uint64_t *visibility) const;
+    void cullAVX2(std::span<const glm::vec4, 6> planes, uint64_t *visibility) const;
+    void cullAVX512(std::span<const glm::vec4, 6> planes, uint64_t *visibility) const;
+};
+
+}
@@ -0,0 +1,39 @@
+/// Copyright 2025 Ana Oliveira, Humberto Gomes, Mariana Rocha, Sara Lopes
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+
+#pragma once
+
+#include <glad/glad.h>
+#include <string>
+
+#include "engine/render/ShaderProgram.hpp"
+
+namespace engine::render {
+
+// Writes only depth, for the pre-pass. Uses the same vertex shader as ShadedShaderProgram, so that
+// the shaded pass can test for equal depth.
+class DepthShaderProgram : public ShaderProgram {
+private:
+    static const std::string fragmentShaderSource;
+    static const GLint firstDrawUniformLocation = 0; // Explicit in the shader
+
+public:
+    DepthShaderProgram();
+    DepthShaderProgram(const DepthShaderProgram &program) = delete;
+    DepthShaderProgram(DepthShaderProgram &&program) = delete;
+
+    void setFirstDraw(GLuint firstDraw) const;
+};
+
+}
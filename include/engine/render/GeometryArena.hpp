@@ -0,0 +1,108 @@
+/// Copyright 2025 Ana Oliveira, Humberto Gomes, Mariana Rocha, Sara Lopes
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <glad/glad.h>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <map>
+#include <memory>
+#include <span>
+
+#include "engine/render/VertexFormat.hpp"
+
+namespace engine::render {
+
+// Large buffers shared by all models of a vertex format, so that any of them can be drawn without
+// changing the bound vertex array
+class GeometryArena {
+public:
+    struct FloatVertex {
+        glm::vec4 position;
+        glm::vec2 textureCoordinate;
+        glm::vec3 normal;
+    };
+
+    struct QuantizedVertex {
+        uint64_t position;
+        uint32_t textureCoordinate, normal;
+    };
+
+    // Same layout as expected by glMultiDrawElementsIndirect
+    struct DrawCommand {
+        GLuint count, instanceCount, firstIndex;
+        GLint baseVertex;
+        GLuint baseInstance;
+    };
+
+    struct Allocation {
+        GLint baseVertex;
+        GLsizei vertexCount;
+        GLuint firstIndex; // In units of indexType
+        GLsizei indexCount;
+        GLenum indexType;
+    };
+
+private:
+    static const size_t initialVertexCapacity = 1 << 16, initialIndexCapacity = 1 << 20;
+    static std::unique_ptr<GeometryArena> arenas[3];
+
+    VertexFormat vertexFormat;
+    size_t vertexSize;
+    GLuint vao, vbo, ibo;
+
+    // Vertex ranges are measured in vertices, index ranges in bytes
+    size_t vertexCapacity, indexCapacity;
+    std::map<size_t, size_t> freeVertices, freeIndices;
+
+public:
+    explicit GeometryArena(VertexFormat _vertexFormat);
+    GeometryArena(const GeometryArena &arena) = delete;
+    GeometryArena(GeometryArena &&arena) = delete;
+    ~GeometryArena();
+
+    // Arenas are created on first use, and must be destroyed before the OpenGL context, after all
+    // models
+    static GeometryArena &get(VertexFormat vertexFormat);
+    static void destroyAll();
+    static size_t getIndexSize(GLenum indexType);
+
+    Allocation
+        allocate(const void *vertices, size_t vertexCount, std::span<const uint32_t> indices);
+    void free(const Allocation &allocation);
+    GLuint getVertexArray() const;
+
+private:
+    void initializeAttribute(GLuint attribute,
+                             GLint components,
+                             GLenum type,
+                             bool normalized,
+                             size_t offset);
+    void attachBuffers() const;
+
+    size_t allocateRange(std::map<size_t, size_t> &freeRanges,
+                         GLuint &buffer,
+                         size_t &capacity,
+                         size_t unitSize,
+                         size_t size);
+    static size_t getIndexRangeSize(size_t indexCount, GLenum indexType);
+    static void freeRange(std::map<size_t, size_t> &freeRanges, size_t offset, size_t size);
+    static GLuint createBuffer(size_t size);
+};
+
+}
@@ -0,0 +1,141 @@
+/// Copyright 2025 Ana Oliveira, Humberto Gomes, Mariana Rocha, Sara Lopes
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <glad/glad.h>
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "engine/render/GeometryArena.hpp"
+#include "engine/render/Model.hpp"
+#include "engine/render/RenderPipelineManager.hpp"
+#include "engine/render/RingBuffer.hpp"
+#include "engine/render/Texture.hpp"
+
+namespace engine::render {
+
+// Collects the visible entities of a frame and draws them with a few multi-draw-indirect calls.
+// Entities sharing a model and a texture become a single instanced command, as materials are
+// indexed per instance.
+class InstanceBatcher {
+public:
+    // Automatic enables the depth pre-pass when the measured overdraw is high
+    enum class DepthPrepass { Disabled, Enabled, Automatic };
+
+private:
+    // Same layouts as in ShadedShaderProgram (std430)
+    struct Instance {
+        glm::mat4 worldMatrix, normalMatrix;
+        GLuint material;
+        GLuint padding[3];
+    };
+
+    struct Draw {
+        glm::mat4 positionDecodeMatrix;
+        glm::vec4 textureCoordinateDecode;
+        GLuint textured;
+        GLuint octahedralNormals;
+        GLuint padding[2];
+    };
+
+    // Commands that can be submitted together, as they share a vertex array, an index type and a
+    // texture
+    struct Submission {
+        const GeometryArena *arena;
+        GLenum indexType;
+        const Texture *texture;
+        uint32_t firstCommand, commandCount;
+    };
+
+    struct Batch {
+        const Model *model;
+        std::shared_ptr<Texture> texture;
+        uint32_t firstInstance, instanceCount;
+        uint32_t textureId;
+        float depth;          // Of the nearest instance
+        glm::mat4 fullMatrix; // Of the last instance, to cull clusters when there's only one
+    };
+
+    // Sort keys are, from the most to the least significant bits: vertex format (2), index type
+    // (1), texture (16), quantized depth (24) and batch index (21)
+    static constexpr uint64_t batchMask = (1 << 21) - 1;
+
+    // Overdraw thresholds for enabling and disabling the automatic pre-pass. They're apart so that
+    // it doesn't toggle every frame.
+    static constexpr float enablePrepassOverdraw = 1.5f;
+    static constexpr float disablePrepassOverdraw = 1.2f;
+
+    // Overdraw is measured with sample queries, read a few frames later to avoid stalling
+    static const int overdrawQueryCount = 3;
+
+    // Instances, draws and commands of the frame are written straight into the ring buffer
+    RingBuffer ringBuffer;
+    std::vector<Batch> batches;
+    std::unordered_map<const Model *, std::vector<uint32_t>> modelBatches;
+    std::unordered_map<const Texture *, uint32_t> textureIds;
+    std::vector<Instance> instances;
+    std::vector<uint32_t> instanceBatches;
+    std::vector<uint64_t> keys, sortScratch;
+
+    std::vector<GeometryArena::DrawCommand> commands;
+    std::vector<Draw> draws;
+    std::vector<Submission> submissions;
+
+    DepthPrepass depthPrepass;
+    bool usingDepthPrepass;
+    GLuint overdrawQueries[overdrawQueryCount];
+    GLint overdrawQueryPixels[overdrawQueryCount]; // 0 when the query isn't pending
+    int nextOverdrawQuery;
+    float overdraw;
+
+public:
+    InstanceBatcher();
+    InstanceBatcher(const InstanceBatcher &batcher) = delete;
+    InstanceBatcher(InstanceBatcher &&batcher) = delete;
+    ~InstanceBatcher();
+
+    void add(const Model &model,
+             const std::shared_ptr<Texture> texture,
+             uint32_t materialIndex,
+             const glm::mat4 &fullMatrix,
+             const glm::mat4 &worldMatrix,
+             const glm::mat4 &normalMatrix);
+
+    void draw(RenderPipelineManager &pipelineManager);
+
+    void setDepthPrepass(DepthPrepass mode);
+    DepthPrepass getDepthPrepass() const;
+    bool isUsingDepthPrepass() const;
+
+    // Samples that passed the depth test per pixel, in the last measured frame
+    float getOverdraw() const;
+
+private:
+    uint32_t getBatch(const Model &model, const std::shared_ptr<Texture> texture);
+    void buildCommands(const RenderPipelineManager &pipelineManager);
+    void submit(RenderPipelineManager &pipelineManager, size_t commandsOffset, bool depthOnly);
+    bool beginOverdrawQuery();
+    void endOverdrawQuery();
+    void clear();
+    uint64_t getSortKey(uint32_t batchIndex) const;
+    static Draw getDraw(const Batch &batch);
+};
+
+}
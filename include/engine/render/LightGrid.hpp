@@ -0,0 +1,92 @@
+/// Copyright 2025 Ana Oliveira, Humberto Gomes, Mariana Rocha, Sara Lopes
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <glm/mat4x4.hpp>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <vector>
+
+#include "engine/render/RingBuffer.hpp"
+
+namespace engine::render {
+
+// Splits the view frustum into clusters (screen tiles, sliced exponentially in depth) and lists
+// the lights that reach each of them, so that a fragment is only lit by the lights near it
+class LightGrid {
+public:
+    static const int columns = 16, rows = 9, slices = 24;
+    static const int clusterCount = columns * rows * slices;
+
+private:
+    // Same layout as in ShadedShaderProgram (std430)
+    struct Cluster {
+        uint32_t firstLight, lightCount;
+    };
+
+    // Inclusive ranges of clusters, empty when first > last
+    struct Cells {
+        int firstColumn, lastColumn, firstRow, lastRow, firstSlice, lastSlice;
+    };
+
+    std::vector<glm::vec4> spheres; // World space center and range of each light
+    std::vector<uint32_t> lightIndices;
+    std::vector<Cells> lightCells;
+
+    // Uploaded together: the clusters, and then the light indices of all clusters
+    std::vector<Cluster> clusters;
+    std::vector<uint32_t> clusterLights;
+    RingBuffer ringBuffer;
+    bool uploaded;
+
+public:
+    LightGrid();
+    LightGrid(const LightGrid &grid) = delete;
+    LightGrid(LightGrid &&grid) = delete;
+
+    void clearLights();
+    void addLight(uint32_t lightIndex, const glm::vec3 &position, float range);
+
+    // Bins the lights for a new camera and binds the result
+    void update(const glm::mat4 &viewMatrix,
+                const glm::mat4 &projectionMatrix,
+                float near,
+                float far);
+
+    // Scale and bias that turn the logarithm of a view depth into a slice
+    static glm::vec2 getSliceTransform(float near, float far);
+
+private:
+    static Cells getCells(const glm::vec4 &sphere,
+                          const glm::mat4 &viewMatrix,
+                          const glm::mat4 &projectionMatrix,
+                          float near,
+                          float far,
+                          const glm::vec2 &sliceTransform);
+    static bool getTiles(float low,
+                         float high,
+                         float nearestDepth,
+                         float farthestDepth,
+                         float scale,
+                         int tiles,
+                         int &first,
+                         int &last);
+    static int getSlice(float depth, const glm::vec2 &sliceTransform);
+    static int getClusterIndex(int column, int row, int slice);
+};
+
+}
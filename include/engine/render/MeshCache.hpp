@@ -0,0 +1,85 @@
+/// Copyright 2025 Ana Oliveira, Humberto Gomes, Mariana Rocha, Sara Lopes
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <glm/vec2.hpp>
+#include <glm/vec4.hpp>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "engine/render/BoundingSphere.hpp"
+#include "utils/MappedFile.hpp"
+#include "utils/WavefrontOBJ.hpp"
+
+namespace engine::render {
+
+class MeshCache {
+private:
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t vertexCount;
+        uint64_t indexCount;
+        uint64_t sourceSize;
+        int64_t sourceModificationTime;
+        uint64_t sourceHash;
+        float boundingSphereCenter[4];
+        float boundingSphereRadius;
+        uint32_t padding[3];
+    };
+
+    static constexpr char magic[8] = { 'C', 'G', 'M', 'E', 'S', 'H', '\0', '\0' };
+    static constexpr uint32_t version = 3;
+
+    std::unique_ptr<utils::MappedFile> file;
+    std::vector<glm::vec4> loadedPositions, loadedNormals;
+    std::vector<glm::vec2> loadedTextureCoordinates;
+    std::vector<uint32_t> loadedIndices;
+
+    std::span<const glm::vec4> positions, normals;
+    std::span<const glm::vec2> textureCoordinates;
+    std::span<const uint32_t> indices;
+    BoundingSphere boundingSphere;
+
+public:
+    explicit MeshCache(const std::string &modelPath);
+    explicit MeshCache(const utils::WavefrontOBJ &object);
+    MeshCache(const MeshCache &cache) = delete;
+    MeshCache(MeshCache &&cache) = delete;
+
+    std::span<const glm::vec4> getPositions() const;
+    std::span<const glm::vec2> getTextureCoordinates() const;
+    std::span<const glm::vec4> getNormals() const;
+    std::span<const uint32_t> getIndices() const;
+    const BoundingSphere &getBoundingSphere() const;
+
+private:
+    bool load(const std::string &cachePath,
+              const std::string &modelPath,
+              uint64_t sourceSize,
+              int64_t sourceModificationTime);
+    void build(const utils::WavefrontOBJ &object);
+    void write(const std::string &cachePath,
+               uint64_t sourceSize,
+               int64_t sourceModificationTime,
+               uint64_t sourceHash) const;
+
+    static uint64_t hashFile(const std::string &filename);
+};
+
+}
@@ -18,57 +18,97 @@
 #include <glad/glad.h>
 #include <glm/mat4x4.hpp>
 #include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
 #include <glm/vec4.hpp>
 #include <memory>
-#include <tuple>
+#include <span>
 #include <vector>
 
 #include "engine/render/BoundingSphere.hpp"
+#include "engine/render/GeometryArena.hpp"
+#include "engine/render/MeshCache.hpp"
 #include "engine/render/NormalsPreview.hpp"
 #include "engine/render/RenderPipelineManager.hpp"
-#include "engine/render/Texture.hpp"
-#include "engine/scene/Material.hpp"
+#include "engine/render/VertexFormat.hpp"
 #include "utils/WavefrontOBJ.hpp"
 
 namespace engine::render {
 
 class Model {
+public:
+    struct QuantizationError {
+        float position, normal, textureCoordinate;
+    };
+
 private:
-    GLuint vao, positionsVBO, textureCoordinatesVBO, normalsVBO, ibo;
-    int vertexCount;
+    struct Cluster {
+        glm::vec3 center;
+        float radius;
+        glm::vec3 coneAxis;
+        float coneCosine, coneSine;
+        uint32_t firstIndex, indexCount;
+    };
+
+    GeometryArena &arena;
+    GeometryArena::Allocation allocation;
+    VertexFormat vertexFormat;
+    glm::mat4 positionDecodeMatrix;
+    glm::vec4 textureCoordinateDecode;
+    QuantizationError quantizationError;
+    std::vector<Cluster> clusters;
     BoundingSphere boundingSphere;
     NormalsPreview normalsPreview;
 
 public:
     explicit Model(const utils::WavefrontOBJ &objectFile);
+    explicit Model(const MeshCache &mesh, VertexFormat _vertexFormat = VertexFormat::Float32);
     Model(const Model &model) = delete;
     Model(Model &&model) = delete;
     ~Model();
 
     const BoundingSphere &getBoundingSphere() const;
     const NormalsPreview &getNormalsPreview() const;
+    int getTriangleCount() const;
+    VertexFormat getVertexFormat() const;
+    const QuantizationError &getQuantizationError() const;
+    const GeometryArena &getArena() const;
+    GLenum getIndexType() const;
+    const glm::mat4 &getPositionDecodeMatrix() const;
+    const glm::vec4 &getTextureCoordinateDecode() const;
 
     void drawSolidColor(RenderPipelineManager &pipelineManager,
                         const glm::mat4 &fullMatrix,
                         const glm::vec4 &color,
                         bool fillPolygons) const;
 
-    void drawShaded(RenderPipelineManager &pipelineManager,
-                    const glm::mat4 &fullMatrix,
-                    const glm::mat4 &worldMatrix,
-                    const glm::mat4 &normalMatrix,
-                    const std::shared_ptr<Texture> texture,
-                    const scene::Material &material) const;
+    // Appends the commands that draw the visible clusters of this model. Clusters can only be
+    // culled when there's a single instance.
+    void getDrawCommands(const RenderPipelineManager &pipelineManager,
+                         const glm::mat4 &fullMatrix,
+                         GLuint firstInstance,
+                         GLuint instanceCount,
+                         std::vector<GeometryArena::DrawCommand> &commands) const;
 
 private:
-    explicit Model(const std::tuple<std::vector<glm::vec4>, // Positions
-                                    std::vector<glm::vec2>, // Texture coordinates
-                                    std::vector<glm::vec4>, // Normals (padded)
-                                    std::vector<uint32_t>> // Indices
-                       &modelData);
-
-    template<class V>
-    void initializeBuffer(GLuint attribute, GLuint vbo, const std::vector<V> &data);
+    void initializeFloatVertices(const MeshCache &mesh);
+    void initializeQuantizedVertices(const MeshCache &mesh);
+    void initializeClusters(const MeshCache &mesh);
+
+    void quantizePositions(std::span<const glm::vec4> positions,
+                           std::span<GeometryArena::QuantizedVertex> vertices);
+    void quantizeTextureCoordinates(std::span<const glm::vec2> textureCoordinates,
+                                    std::span<GeometryArena::QuantizedVertex> vertices);
+    void quantizeNormals(std::span<const glm::vec4> normals,
+                         std::span<GeometryArena::QuantizedVertex> vertices);
+
+    void drawElements(RenderPipelineManager &pipelineManager, const glm::mat4 &fullMatrix) const;
+    static bool isClusterVisible(const Cluster &cluster,
+                                 std::span<const glm::vec4, 6> frustumPlanes,
+                                 const glm::vec3 &cameraPosition,
+                                 bool cullBackFaces);
+
+    static glm::vec2 encodeOctahedral(const glm::vec3 &normal);
+    static glm::vec3 decodeOctahedral(const glm::vec2 &encoded);
 };
 
 }
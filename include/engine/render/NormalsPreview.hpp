@@ -18,7 +18,7 @@
 #include <glad/glad.h>
 #include <glm/mat4x4.hpp>
 #include <glm/vec4.hpp>
-#include <vector>
+#include <span>
 
 #include "engine/render/RenderPipelineManager.hpp"
 
@@ -30,9 +30,9 @@ private:
     int vertexCount;
 
 public:
-    NormalsPreview(const std::vector<glm::vec4> &positions,
-                   const std::vector<glm::vec4> &normals,
-                   const std::vector<uint32_t> &indices);
+    NormalsPreview(std::span<const glm::vec4> positions,
+                   std::span<const glm::vec4> normals,
+                   std::span<const uint32_t> indices);
     NormalsPreview(const NormalsPreview &normalsPreview) = delete;
     NormalsPreview(NormalsPreview &&normalsPreview) = delete;
     ~NormalsPreview();
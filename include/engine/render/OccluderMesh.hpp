@@ -0,0 +1,42 @@
+/// Copyright 2025 Ana Oliveira, Humberto Gomes, Mariana Rocha, Sara Lopes
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <glm/vec3.hpp>
+#include <span>
+#include <vector>
+
+#include "engine/render/MeshCache.hpp"
+
+namespace engine::render {
+
+// Triangles of a model kept in main memory, for the software occlusion rasterizer. Meshes used
+// as occluders must fit inside what they hide, or visible entities will be culled.
+class OccluderMesh {
+private:
+    std::vector<glm::vec3> positions;
+    std::vector<uint32_t> indices;
+
+public:
+    explicit OccluderMesh(const MeshCache &mesh);
+    OccluderMesh(const OccluderMesh &mesh) = delete;
+    OccluderMesh(OccluderMesh &&mesh) = delete;
+
+    std::span<const glm::vec3> getPositions() const;
+    std::span<const uint32_t> getIndices() const;
+};
+
+}
@@ -0,0 +1,79 @@
+/// Copyright 2025 Ana Oliveira, Humberto Gomes, Mariana Rocha, Sara Lopes
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <glm/mat4x4.hpp>
+#include <glm/vec4.hpp>
+#include <vector>
+
+#include "engine/render/BoundingSphere.hpp"
+#include "engine/render/OccluderMesh.hpp"
+#include "utils/JobSystem.hpp"
+
+namespace engine::render {
+
+// Rasterizes occluders into a small depth buffer on the CPU, so that entities hidden behind them
+// can be skipped before being batched. Rows of tiles are split between jobs.
+class OcclusionCuller {
+private:
+    // Each tile is a block of 8x4 pixels, so that each of its rows fits in an AVX register
+    static const int width = 320, height = 192;
+    static const int tileWidth = 8, tileHeight = 4, tileSize = tileWidth * tileHeight;
+    static const int tileColumns = width / tileWidth, tileRows = height / tileHeight;
+    static const int rowsPerJob = 4;
+
+    // Screen-space triangle, with edge functions that are positive inside it, and with the plane of
+    // its depth
+    struct Triangle {
+        float edges[3][3];
+        float depth[3];
+        int minX, minY, maxX, maxY; // Bounding box, in pixels
+    };
+
+    // Depths are stored as 1 / w, so that they can be interpolated linearly in screen space. 0 is
+    // infinitely far away.
+    std::vector<float> depthBuffer;     // Tile after tile
+    std::vector<float> farthestDepths;  // Of each tile
+    std::vector<Triangle> triangles;
+    std::vector<glm::vec4> clipPositions; // Of the last occluder's vertices
+    glm::mat4 viewMatrix, projectionMatrix;
+    bool enabled, avx2;
+    int occludedEntities;
+
+    utils::JobSystem &jobSystem;
+
+public:
+    explicit OcclusionCuller(utils::JobSystem &_jobSystem);
+    OcclusionCuller(const OcclusionCuller &culler) = delete;
+    OcclusionCuller(OcclusionCuller &&culler) = delete;
+
+    // Occluders must be added between beginFrame() and rasterize(), and entities can only be tested
+    // after rasterize()
+    void beginFrame(const glm::mat4 &_viewMatrix, const glm::mat4 &_projectionMatrix, bool enable);
+    void addOccluder(const OccluderMesh &mesh, const glm::mat4 &fullMatrix);
+    void rasterize();
+
+    bool isOccluded(const BoundingSphere &sphere) const;
+    void countOccluded(int entityCount);
+    int getOccludedEntities() const;
+
+private:
+    void rasterizeRows(int firstRow, int lastRow);
+    void rasterizeTile(const Triangle &triangle, float *tile, int x, int y) const;
+    void rasterizeTileAVX2(const Triangle &triangle, float *tile, int x, int y) const;
+};
+
+}
@@ -14,28 +14,91 @@
 
 #pragma once
 
+#include <glad/glad.h>
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <memory>
+#include <vector>
+
+#include "engine/render/DepthShaderProgram.hpp"
+#include "engine/render/LightGrid.hpp"
 #include "engine/render/ShadedShaderProgram.hpp"
 #include "engine/render/ShaderProgram.hpp"
 #include "engine/render/SolidColorShaderProgram.hpp"
+#include "engine/render/Texture.hpp"
+#include "engine/scene/light/Light.hpp"
+#include "engine/scene/Material.hpp"
 
 namespace engine::render {
 
 class RenderPipelineManager {
 private:
+    // Same layouts as in ShadedShaderProgram (std140 and std430)
+    struct FrameUniforms {
+        glm::mat4 cameraMatrix;
+        glm::vec3 cameraPosition;
+        float clusterScale, clusterBias;
+        float padding[3];
+    };
+
+    struct LightData {
+        glm::vec3 position;
+        float cutoff;
+        glm::vec3 direction;
+        float range;
+    };
+
+    struct MaterialData {
+        glm::vec3 diffuse;
+        float shininess;
+        glm::vec3 ambient;
+        float padding0;
+        glm::vec3 specular;
+        float padding1;
+        glm::vec3 emissive;
+        float padding2;
+    };
+
+    GLuint frameUniformBuffer, lightStorageBuffer, materialStorageBuffer;
+    FrameUniforms currentFrame;
+    LightGrid lightGrid;
+    bool clustersOutdated; // By a new camera or new lights
+
     ShadedShaderProgram shadedShaderProgram;
+    DepthShaderProgram depthShaderProgram;
     SolidColorShaderProgram solidColorShaderProgram;
     ShaderProgram *currentProgram;
-    bool currentfillPolygons;
+    GLuint currentVertexArray;
+    const Texture *currentTexture;
+    bool currentfillPolygons, currentBackFaceCulling;
 
 public:
-    RenderPipelineManager(int pointLights, int directionalLights, int spotlights);
+    explicit RenderPipelineManager(const std::vector<scene::Material> &materials);
     RenderPipelineManager(const RenderPipelineManager &model) = delete;
     RenderPipelineManager(RenderPipelineManager &&) = delete;
+    ~RenderPipelineManager();
+
+    // Buffers are only uploaded when their contents change. Lights must be set before the camera,
+    // which is when they're binned into clusters.
+    void setLights(const std::vector<std::unique_ptr<scene::light::Light>> &lights);
+    void setCamera(const glm::mat4 &viewMatrix,
+                   const glm::mat4 &projectionMatrix,
+                   const glm::vec3 &cameraPosition,
+                   float near,
+                   float far);
 
     void setFillPolygons(bool fillPolygons);
+    void setBackFaceCulling(bool backFaceCulling);
+    bool isCullingBackFaces() const;
+
+    // Vertex arrays and textures must only be bound here while drawing, or the cached bindings
+    // won't match OpenGL's
+    void bindVertexArray(GLuint vao);
+    void useTexture(const Texture &texture);
 
     const SolidColorShaderProgram &getSolidColorShaderProgram();
     const ShadedShaderProgram &getShadedShaderProgram();
+    const DepthShaderProgram &getDepthShaderProgram();
 
 private:
     void useProgram(ShaderProgram *program);
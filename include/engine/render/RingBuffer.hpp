@@ -0,0 +1,60 @@
+/// Copyright 2025 Ana Oliveira, Humberto Gomes, Mariana Rocha, Sara Lopes
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <glad/glad.h>
+
+namespace engine::render {
+
+// A persistently mapped buffer split into one segment per frame in flight. The CPU writes a frame
+// into a segment while the GPU still reads the previous ones, and fences stop a segment from
+// being overwritten before the GPU is done with it.
+class RingBuffer {
+private:
+    static const int segmentCount = 3;
+    static const size_t initialSegmentSize = 1 << 20;
+
+    GLuint buffer;
+    char *mapping;
+    size_t segmentSize, alignment;
+    GLsync fences[segmentCount];
+    int currentSegment;
+    size_t used;
+
+public:
+    RingBuffer();
+    RingBuffer(const RingBuffer &buffer) = delete;
+    RingBuffer(RingBuffer &&buffer) = delete;
+    ~RingBuffer();
+
+    // Waits for the next segment to be free, growing the buffer if size doesn't fit in it
+    void beginFrame(size_t size);
+    void endFrame();
+
+    // Returns the offset of the allocation in the buffer, aligned for storage buffer bindings.
+    // Only valid between beginFrame and endFrame, for a total no larger than the size given.
+    size_t allocate(size_t size, void *&data);
+    GLuint getBuffer() const;
+
+    size_t getAlignedSize(size_t size) const;
+
+private:
+    void create(size_t _segmentSize);
+    void destroy();
+    static void wait(GLsync &fence);
+};
+
+}
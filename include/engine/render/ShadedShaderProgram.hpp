@@ -15,48 +15,31 @@
 #pragma once
 
 #include <glad/glad.h>
-#include <glm/mat4x4.hpp>
-#include <glm/vec3.hpp>
-#include <memory>
 #include <string>
-#include <vector>
 
 #include "engine/render/ShaderProgram.hpp"
-#include "engine/render/Texture.hpp"
-#include "engine/scene/light/Light.hpp"
-#include "engine/scene/Material.hpp"
 
 namespace engine::render {
 
 class ShadedShaderProgram : public ShaderProgram {
 private:
-    static const std::string vertexShaderSource, fragmentShaderSource;
-    int pointLights, directionalLights, spotlights;
-
-    GLint fullMatrixUniformLocation, worldMatrixUniformLocation, normalMatrixUniformLocation,
-        cameraPositionUniformLocation, texturedUniformLocation, diffuseUniformLocation,
-        ambientUniformLocation, specularUniformLocation, emissiveUniformLocation,
-        shininessUniformLocation, pointPositionsUniformLocation,
-        directionalDirectionsUniformLocation, spotPositionsUniformLocation,
-        spotDirectionsUniformLocation, spotCutoffsUniformLocation;
+    static const std::string commonSource, vertexShaderSource, fragmentShaderSource;
+    static const GLint firstDrawUniformLocation = 0; // Explicit in the shader
 
 public:
-    ShadedShaderProgram(int _pointLights, int _directionalLights, int _spotlights);
+    // Per-instance data and per-draw records are read from the buffers bound by InstanceBatcher.
+    // The camera, materials, lights and light clusters come from RenderPipelineManager's buffers.
+    ShadedShaderProgram();
     ShadedShaderProgram(const ShadedShaderProgram &program) = delete;
     ShadedShaderProgram(ShadedShaderProgram &&program) = delete;
 
-    void setFullMatrix(const glm::mat4 &fullMatrix) const;
-    void setWorldMatrix(const glm::mat4 &worldMatrix) const;
-    void setNormalMatrix(const glm::mat4 &normalMatrix) const;
-    void setCameraPosition(const glm::vec3 &position) const;
+    void setFirstDraw(GLuint firstDraw) const;
 
-    void setTexture(const Texture &texture, const scene::Material &material) const;
-    void setMaterial(const scene::Material &material) const;
-    void setLights(const std::vector<std::unique_ptr<scene::light::Light>> &lights) const;
+    // Also used by DepthShaderProgram
+    static std::string initializeVertexShader();
 
 private:
-    static std::string
-        initializeFragmentShader(int pointLights, int directionalLights, int spotlights);
+    static std::string initializeFragmentShader();
 };
 
 }
@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <glad/glad.h>
 #include <string>
 
@@ -21,7 +22,17 @@ namespace engine::render {
 
 class ShaderProgram {
 private:
+    struct BinaryHeader {
+        char magic[8];
+        uint32_t format;
+        uint32_t length;
+    };
+
+    static constexpr char binaryMagic[8] = { 'C', 'G', 'P', 'R', 'O', 'G', '\0', '\0' };
+
     GLuint vertexShader, fragmentShader, program;
+    std::string binaryPath; // Where to store the program once linked, empty if loaded from there
+    mutable bool linked;
 
 public:
     ShaderProgram(const std::string &vertexShaderSource, const std::string &fragmentShaderSource);
@@ -29,13 +40,21 @@ public:
     ShaderProgram(ShaderProgram &&program) = delete;
     ~ShaderProgram();
 
+    // Programs not found in the cache are linked in the background, so that several can be
+    // compiled at once. This waits for linking to finish, and throws if it failed.
+    void waitForLinking() const;
     void use() const;
 
-protected:
-    GLint getUniformLocation(const std::string &name);
-
 private:
+    bool loadBinary();
+    void storeBinary() const;
     GLuint compileShader(GLenum type, const std::string &source);
+    static void checkShader(GLuint shader);
+
+    static std::string getBinaryPath(const std::string &vertexShaderSource,
+                                     const std::string &fragmentShaderSource);
+    static uint64_t hashString(const char *str, uint64_t hash);
+    static void enableParallelCompilation();
 };
 
 }
@@ -26,7 +26,8 @@ namespace engine::render {
 class SolidColorShaderProgram : public ShaderProgram {
 private:
     static const std::string vertexShaderSource, fragmentShaderSource;
-    GLint fullMatrixUniformLocation, colorUniformLocation;
+    // Explicit locations, so that they don't need to be queried after linking
+    static const GLint fullMatrixUniformLocation = 0, colorUniformLocation = 1;
 
 public:
     SolidColorShaderProgram();
@@ -14,18 +14,25 @@
 
 #pragma once
 
+#include <cstdint>
 #include <filesystem>
 #include <glm/mat4x4.hpp>
 #include <memory>
 #include <string>
 #include <tinyxml2.h>
 #include <unordered_map>
+#include <vector>
 
 #include "engine/render/BoundingSphere.hpp"
+#include "engine/render/InstanceBatcher.hpp"
 #include "engine/render/Model.hpp"
 #include "engine/render/NormalsPreview.hpp"
+#include "engine/render/OccluderMesh.hpp"
+#include "engine/render/OcclusionCuller.hpp"
 #include "engine/render/RenderPipelineManager.hpp"
 #include "engine/render/Texture.hpp"
+#include "engine/render/VertexFormat.hpp"
+#include "engine/scene/camera/Camera.hpp"
 #include "engine/scene/Material.hpp"
 
 namespace engine::scene {
@@ -33,21 +40,23 @@ namespace engine::scene {
 class Entity {
 private:
     std::shared_ptr<render::Model> model;
-    render::BoundingSphere boundingSphere;
+    std::vector<std::shared_ptr<render::Model>> lods;
+    std::unique_ptr<render::OccluderMesh> occluder; // Only for entities marked as occluders
     std::shared_ptr<render::Texture> texture;
-    Material material;
+    uint32_t materialIndex; // In the scene's material table
     std::string name;
 
 public:
     Entity(const tinyxml2::XMLElement *modelElement,
            const std::filesystem::path &sceneDirectory,
+           render::VertexFormat vertexFormat,
            std::unordered_map<std::string, std::shared_ptr<render::Model>> &loadedModels,
-           std::unordered_map<std::string, std::shared_ptr<render::Texture>> &loadedTextures);
+           std::unordered_map<std::string, std::shared_ptr<render::Texture>> &loadedTextures,
+           std::vector<Material> &loadedMaterials);
     Entity(const Entity &entity) = delete;
     Entity(Entity &&entity) = delete;
 
-    void updateBoundingSphere(const glm::mat4 &worldTransform);
-    const render::BoundingSphere &getBoundingSphere() const;
+    const render::BoundingSphere &getModelBoundingSphere() const;
     const render::NormalsPreview &getNormalsPreview() const;
     const std::string &getName() const;
 
@@ -56,11 +65,22 @@ public:
                         const glm::vec4 &color,
                         bool fillPolygons) const;
 
-    void draw(render::RenderPipelineManager &pipelineManager,
+    bool draw(render::RenderPipelineManager &pipelineManager,
+              render::InstanceBatcher &instanceBatcher,
+              const camera::Camera &camera,
+              const render::BoundingSphere &boundingSphere,
               const glm::mat4 &fullMatrix,
               const glm::mat4 &worldMatrix,
               const glm::mat4 &normalMatrix,
               bool fillPolygons) const;
+
+    void addOccluder(render::OcclusionCuller &occlusionCuller, const glm::mat4 &fullMatrix) const;
+
+private:
+    static std::shared_ptr<render::Model> loadModel(
+        const std::string &modelPath,
+        render::VertexFormat vertexFormat,
+        std::unordered_map<std::string, std::shared_ptr<render::Model>> &loadedModels);
 };
 
 }
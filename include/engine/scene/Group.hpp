@@ -15,71 +15,41 @@
 #pragma once
 
 #include <filesystem>
-#include <glm/mat4x4.hpp>
-#include <glm/vec4.hpp>
 #include <memory>
 #include <string>
 #include <tinyxml2.h>
 #include <unordered_map>
 #include <vector>
 
-#include "engine/render/BoundingSphere.hpp"
 #include "engine/render/Model.hpp"
-#include "engine/render/RenderPipelineManager.hpp"
 #include "engine/render/Texture.hpp"
-#include "engine/scene/camera/Camera.hpp"
+#include "engine/render/VertexFormat.hpp"
 #include "engine/scene/Entity.hpp"
+#include "engine/scene/Material.hpp"
 #include "engine/scene/transform/TRSTransform.hpp"
 
 namespace engine::scene {
 
+// A group as parsed from the scene XML. It's compiled into a SceneGraph for updating and drawing.
 class Group {
 private:
     std::vector<std::unique_ptr<Entity>> entities;
     std::vector<std::unique_ptr<Group>> groups;
-    render::BoundingSphere boundingSphere;
     transform::TRSTransform transform;
 
 public:
     Group(const tinyxml2::XMLElement *groupElement,
           const std::filesystem::path &sceneDirectory,
+          render::VertexFormat vertexFormat,
           std::unordered_map<std::string, std::shared_ptr<render::Model>> &loadedModels,
-          std::unordered_map<std::string, std::shared_ptr<render::Texture>> &loadedTextures);
+          std::unordered_map<std::string, std::shared_ptr<render::Texture>> &loadedTextures,
+          std::vector<Material> &loadedMaterials);
     Group(const Group &group) = delete;
     Group(Group &&group) = delete;
 
-    int getEntityCount() const;
-
-    void update(const glm::mat4 &worldTransform, float time);
-
-    void drawSolidColorParts(render::RenderPipelineManager &pipelineManager,
-                             const camera::Camera &camera,
-                             const glm::mat4 &worldTransform,
-                             bool showBoundingSpheres,
-                             bool showAnimationLines,
-                             bool showNormals) const;
-    int drawShadedParts(render::RenderPipelineManager &pipelineManager,
-                        const camera::Camera &camera,
-                        const glm::mat4 &worldtransform,
-                        bool fillPolygons) const;
-
-    int drawForPicking(render::RenderPipelineManager &pipelineManager,
-                       const camera::Camera &camera,
-                       const glm::mat4 &worldTransform,
-                       std::unordered_map<int, std::string> &idToName,
-                       int currentId) const;
-
-private:
-    const render::BoundingSphere &getBoundingSphere() const;
-    void updateBoundingSphere(const glm::mat4 &worldTransform);
-
-    template<class T>
-    glm::vec4 sumBoundingSphereCenters(const std::vector<std::unique_ptr<T>> &ts,
-                                       const glm::mat4 &subTransform);
-
-    template<class T>
-    float calculateBoundingSphereRadius(const std::vector<std::unique_ptr<T>> &ts,
-                                        const glm::vec4 &groupCenter);
+    const std::vector<std::unique_ptr<Entity>> &getEntities() const;
+    const std::vector<std::unique_ptr<Group>> &getGroups() const;
+    transform::TRSTransform &getTransform();
 };
 
 }
@@ -36,6 +36,8 @@ public:
     const glm::vec3 &getSpecular() const;
     const glm::vec3 &getEmissive() const;
     float getShininess() const;
+
+    bool operator==(const Material &material) const;
 };
 
 }
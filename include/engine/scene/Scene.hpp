@@ -20,10 +20,14 @@
 #include <vector>
 
 #include "engine/render/Axis.hpp"
+#include "engine/render/InstanceBatcher.hpp"
+#include "engine/render/Model.hpp"
+#include "engine/render/OcclusionCuller.hpp"
 #include "engine/render/RenderPipelineManager.hpp"
 #include "engine/scene/camera/Camera.hpp"
-#include "engine/scene/Group.hpp"
 #include "engine/scene/light/Light.hpp"
+#include "engine/scene/Material.hpp"
+#include "engine/scene/SceneGraph.hpp"
 
 namespace engine::scene {
 
@@ -31,9 +35,11 @@ class Scene {
 private:
     int windowWidth, windowHeight;
     std::unique_ptr<camera::Camera> camera;
-    std::vector<std::unique_ptr<Group>> groups;
+    std::unique_ptr<SceneGraph> graph;
     render::Axis xAxis, yAxis, zAxis;
     std::vector<std::unique_ptr<light::Light>> lights;
+    bool lightsChanged; // Lights are uploaded on the next draw
+    std::vector<Material> materials; // Deduplicated, indexed by entities
 
 public:
     explicit Scene(const std::string &file);
@@ -43,25 +49,30 @@ public:
     int getWindowWidth() const;
     int getWindowHeight() const;
     int getEntityCount() const;
-    int getPointLightCount() const;
-    int getDirectionalLightCount() const;
-    int getSpotlightCount() const;
+    const std::vector<Material> &getMaterials() const;
     camera::Camera &getCamera();
 
     void setWindowSize(int width, int height);
 
-    void update(float time);
+    void update(float time, utils::JobSystem &jobSystem);
 
     int draw(render::RenderPipelineManager &pipelineManager,
+             render::InstanceBatcher &instanceBatcher,
+             render::OcclusionCuller &occlusionCuller,
              bool fillPolygons,
              bool backFaceCulling,
              bool showAxes,
              bool showBoundingSpheres,
              bool showAnimationLines,
-             bool showNormals) const;
+             bool showNormals,
+             bool occlusionCulling);
 
     void drawForPicking(render::RenderPipelineManager &pipelineManager,
                         std::unordered_map<int, std::string> &idToName) const;
+
+private:
+    static void reportQuantizationError(
+        const std::unordered_map<std::string, std::shared_ptr<render::Model>> &loadedModels);
 };
 
 }
@@ -0,0 +1,129 @@
+/// Copyright 2025 Ana Oliveira, Humberto Gomes, Mariana Rocha, Sara Lopes
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <glm/mat4x4.hpp>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "engine/render/BoundingSphere.hpp"
+#include "engine/render/BoundingSphereArray.hpp"
+#include "engine/render/InstanceBatcher.hpp"
+#include "engine/render/OcclusionCuller.hpp"
+#include "engine/render/RenderPipelineManager.hpp"
+#include "engine/scene/camera/Camera.hpp"
+#include "engine/scene/Entity.hpp"
+#include "engine/scene/Group.hpp"
+#include "engine/scene/transform/TRSTransform.hpp"
+#include "utils/JobSystem.hpp"
+
+namespace engine::scene {
+
+// A tree of groups flattened into arrays, in depth-first order. Parents always come before their
+// children, so world matrices are computed in a single linear pass, and each subtree is a
+// contiguous range of groups and of entities that can be skipped at once when culled. After the
+// first update, only the subtrees of animated groups and their ancestors are updated.
+//
+// Independent subtrees are updated in parallel. Their ancestors are updated before (matrices) and
+// after (bounds) them, on the calling thread.
+class SceneGraph {
+private:
+    static constexpr uint32_t noParent = UINT32_MAX;
+    static const uint32_t maximumTaskGroups = 256; // Larger subtrees are split between tasks
+    static const uint32_t subtreesPerJob = 8;
+
+    // Parsed tree, only kept as the owner of entities and transforms
+    std::vector<std::unique_ptr<Group>> roots;
+    glm::mat4 rootTransform;
+
+    // Groups. Those of a group's subtree are [i, subtreeEnds[i]), and its own entities are
+    // [firstEntities[i], firstEntities[i + 1]). firstEntities has an extra element at the end.
+    std::vector<uint32_t> parents, subtreeEnds, firstEntities;
+    std::vector<transform::TRSTransform *> transforms;
+    std::vector<glm::mat4> worldMatrices;
+    render::BoundingSphereArray groupBoundingSpheres;
+
+    // Groups with time-dependent transforms. Everything else is static. Animated roots are those
+    // that aren't in the subtree of another animated group.
+    std::vector<uint8_t> animated;
+    std::vector<uint32_t> animatedRoots;
+
+    // Groups whose subtrees are updated as a whole by a task, and the ancestors of those subtrees,
+    // in depth-first order
+    std::vector<uint32_t> taskRoots, taskAncestors;
+
+    std::vector<uint8_t> dirtyFlags; // Groups whose bounds must be recomputed
+    std::vector<uint32_t> dirtyGroups;
+    bool outdated; // Everything must be updated, after loading or when the root moves
+
+    // Entities, in the order of their groups
+    std::vector<const Entity *> entities;
+    std::vector<render::BoundingSphere> modelBoundingSpheres;
+    render::BoundingSphereArray entityBoundingSpheres;
+
+    // Frustum culling results, reused until the camera or the scene moves
+    mutable std::vector<uint64_t> groupVisibility, entityVisibility;
+    mutable glm::mat4 culledCameraMatrix;
+    mutable bool culled;
+
+public:
+    explicit SceneGraph(std::vector<std::unique_ptr<Group>> &&_roots);
+    explicit SceneGraph(std::unique_ptr<Group> root);
+    SceneGraph(const SceneGraph &graph) = delete;
+    SceneGraph(SceneGraph &&graph) = delete;
+
+    int getEntityCount() const;
+
+    // Without a job system, everything is updated on the calling thread
+    void update(const glm::mat4 &_rootTransform, float time, utils::JobSystem *jobSystem);
+
+    void drawSolidColorParts(render::RenderPipelineManager &pipelineManager,
+                             const camera::Camera &camera,
+                             bool showBoundingSpheres,
+                             bool showAnimationLines,
+                             bool showNormals) const;
+    void addOccluders(render::OcclusionCuller &occlusionCuller,
+                      const camera::Camera &camera) const;
+    int drawShadedParts(render::RenderPipelineManager &pipelineManager,
+                        render::InstanceBatcher &instanceBatcher,
+                        render::OcclusionCuller &occlusionCuller,
+                        const camera::Camera &camera,
+                        bool fillPolygons) const;
+    int drawForPicking(render::RenderPipelineManager &pipelineManager,
+                       const camera::Camera &camera,
+                       std::unordered_map<int, std::string> &idToName,
+                       int currentId) const;
+
+private:
+    void compile();
+    void addGroup(Group &group, uint32_t parent);
+    void splitIntoTasks(uint32_t group);
+    void updateAll(float time, utils::JobSystem *jobSystem);
+    void updateSubtrees(const std::vector<uint32_t> &subtrees,
+                        float time,
+                        bool animatedOnly,
+                        utils::JobSystem *jobSystem);
+    void updateSubtree(uint32_t group, float time, bool animatedOnly);
+    void updateGroup(uint32_t group);
+    void cull(const camera::Camera &camera) const;
+    void markDirty(uint32_t group);
+    void updateGroupBoundingSphere(uint32_t group);
+    const glm::mat4 &getParentMatrix(uint32_t group) const;
+};
+
+}
@@ -15,12 +15,17 @@
 #pragma once
 
 #include <array>
+#include <cstdint>
 #include <glm/mat4x4.hpp>
 #include <glm/vec2.hpp>
 #include <glm/vec3.hpp>
 #include <unordered_map>
+#include <vector>
 
 #include "engine/render/BoundingSphere.hpp"
+#include "engine/render/BoundingSphereArray.hpp"
+#include "engine/render/InstanceBatcher.hpp"
+#include "engine/render/OcclusionCuller.hpp"
 #include "engine/render/RenderPipelineManager.hpp"
 
 namespace engine::scene::camera {
@@ -28,9 +33,10 @@ namespace engine::scene::camera {
 class Camera {
 protected:
     glm::vec3 position, lookAt, up;
-    float fov, near, far, aspectRatio;
+    float fov, near, far, aspectRatio, windowHeight;
+    float lodTriangleSize, minimumProjectedSize;
 
-    glm::mat4 cameraMatrix;
+    glm::mat4 viewMatrix, projectionMatrix, cameraMatrix;
     std::array<glm::vec4, 6> viewFrustum;
 
 public:
@@ -42,10 +48,18 @@ public:
            float _far);
 
     const glm::vec3 &getPosition() const;
+    const glm::mat4 &getViewMatrix() const;
+    const glm::mat4 &getProjectionMatrix() const;
     const glm::mat4 &getCameraMatrix() const;
+    float getNear() const;
+    float getFar() const;
+    float getLODTriangleSize() const;
+    float getMinimumProjectedSize() const;
 
     virtual void setPosition(const glm::vec3 &pos);
     void setWindowSize(int width, int height);
+    void setLODTriangleSize(float size);
+    void setMinimumProjectedSize(float size);
 
     virtual void move(const glm::vec3 &v);
     virtual void pan(const glm::vec2 &v);
@@ -60,18 +74,19 @@ public:
                                      bool showAnimationLines,
                                      bool showNormals) const;
     virtual int drawShadedParts(render::RenderPipelineManager &pipelineManager,
+                                render::InstanceBatcher &instanceBatcher,
+                                render::OcclusionCuller &occlusionCuller,
                                 bool fillPolygons) const;
     virtual int drawForPicking(render::RenderPipelineManager &pipelineManager,
                                std::unordered_map<int, std::string> &idToName,
                                int currentId) const;
 
-    bool isInFrustum(const render::BoundingSphere &sphere) const;
+    void cullSpheres(const render::BoundingSphereArray &spheres,
+                     std::vector<uint64_t> &visibility) const;
+    float getProjectedSize(const render::BoundingSphere &sphere) const;
 
 protected:
     virtual void updateWithMotion();
-
-private:
-    static glm::vec4 planeEquation(const glm::vec3 &p1, const glm::vec3 &p2, const glm::vec3 &p3);
 };
 
 }
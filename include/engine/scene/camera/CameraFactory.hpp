@@ -19,10 +19,13 @@
 #include <string>
 #include <tinyxml2.h>
 #include <unordered_map>
+#include <vector>
 
 #include "engine/render/Model.hpp"
 #include "engine/render/Texture.hpp"
+#include "engine/render/VertexFormat.hpp"
 #include "engine/scene/camera/Camera.hpp"
+#include "engine/scene/Material.hpp"
 
 namespace engine::scene::camera {
 
@@ -31,8 +34,10 @@ public:
     static std::unique_ptr<Camera> createFromXML(
         const tinyxml2::XMLElement *cameraElement,
         const std::filesystem::path &sceneDirectory,
+        render::VertexFormat vertexFormat,
         std::unordered_map<std::string, std::shared_ptr<render::Model>> &loadedModels,
-        std::unordered_map<std::string, std::shared_ptr<render::Texture>> &loadedTextures);
+        std::unordered_map<std::string, std::shared_ptr<render::Texture>> &loadedTextures,
+        std::vector<Material> &loadedMaterials);
 };
 
 }
@@ -21,13 +21,14 @@
 
 #include "engine/scene/camera/OrbitalCamera.hpp"
 #include "engine/scene/Group.hpp"
+#include "engine/scene/SceneGraph.hpp"
 
 namespace engine::scene::camera {
 
 class ThirdPersonCamera : public OrbitalCamera {
 private:
     glm::mat4 playerTransform;
-    std::unique_ptr<scene::Group> player;
+    scene::SceneGraph player;
 
 public:
     ThirdPersonCamera(const glm::vec3 &_position,
@@ -49,6 +50,8 @@ public:
                                      bool showAnimationLines,
                                      bool showNormals) const override;
     virtual int drawShadedParts(render::RenderPipelineManager &pipelineManager,
+                                render::InstanceBatcher &instanceBatcher,
+                                render::OcclusionCuller &occlusionCuller,
                                 bool fillPolygons) const override;
     virtual int drawForPicking(render::RenderPipelineManager &pipelineManager,
                                std::unordered_map<int, std::string> &idToName,
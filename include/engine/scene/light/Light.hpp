@@ -17,11 +17,20 @@
 namespace engine::scene::light {
 
 class Light {
+public:
+    // Lets lights be packed for the GPU without RTTI
+    enum class Type { Point, Directional, Spot };
+
+private:
+    Type type;
+
 protected:
-    Light();
+    explicit Light(Type _type);
 
 public:
     virtual ~Light() = default;
+
+    Type getType() const;
 };
 
 }
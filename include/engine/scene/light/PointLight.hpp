@@ -23,10 +23,12 @@ namespace engine::scene::light {
 class PointLight : public Light {
 private:
     glm::vec3 position;
+    float range;
 
 public:
-    explicit PointLight(const glm::vec3 &_position);
+    PointLight(const glm::vec3 &_position, float _range);
     const glm::vec3 &getPosition() const;
+    float getRange() const;
 };
 
 }
@@ -25,13 +25,18 @@ private:
     glm::vec3 position;
     glm::vec3 direction;
     float cutoff;
+    float range;
 
 public:
-    explicit Spotlight(const glm::vec3 &_position, const glm::vec3 &_direction, float _cutoff);
+    Spotlight(const glm::vec3 &_position,
+              const glm::vec3 &_direction,
+              float _cutoff,
+              float _range);
 
     const glm::vec3 &getPosition() const;
     const glm::vec3 &getDirection() const;
     float getCutoff() const;
+    float getRange() const;
 };
 
 }
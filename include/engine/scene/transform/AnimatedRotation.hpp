@@ -30,6 +30,7 @@ public:
     explicit AnimatedRotation(const tinyxml2::XMLElement *rotateElement);
 
     void update(float time) override;
+    bool isAnimated() const override;
 };
 
 }
@@ -40,6 +40,7 @@ public:
     explicit AnimatedTranslation(const tinyxml2::XMLElement *translateElement);
 
     void update(float time) override;
+    bool isAnimated() const override;
     void draw(render::RenderPipelineManager &pipelineManager,
               const glm::mat4 &transformMatrix) const override;
 
@@ -30,6 +30,7 @@ public:
 
     virtual void update(float time);
     virtual const glm::mat4 &getMatrix() const;
+    virtual bool isAnimated() const; // If the matrix depends on time
     virtual void draw(render::RenderPipelineManager &pipelineManager,
                       const glm::mat4 &transformMatrix) const;
 };
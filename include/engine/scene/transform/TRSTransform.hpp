@@ -32,6 +32,7 @@ public:
     explicit TRSTransform(const tinyxml2::XMLElement *transformElement);
 
     void update(float time) override;
+    bool isAnimated() const override;
     void draw(render::RenderPipelineManager &pipelineManager,
               const glm::mat4 &transformMatrix) const override;
 };
@@ -14,26 +14,35 @@
 
 #pragma once
 
+#include "engine/render/InstanceBatcher.hpp"
+#include "engine/render/OcclusionCuller.hpp"
 #include "engine/render/RenderPipelineManager.hpp"
 #include "engine/scene/camera/CameraController.hpp"
 #include "engine/scene/Scene.hpp"
 #include "engine/window/UI.hpp"
 #include "engine/window/Window.hpp"
+#include "utils/JobSystem.hpp"
 
 namespace engine::window {
 
 class SceneWindow : public Window {
 private:
+    utils::JobSystem jobSystem;
     scene::Scene scene;
     render::RenderPipelineManager pipelineManager;
+    render::InstanceBatcher instanceBatcher;
+    render::OcclusionCuller occlusionCuller;
     scene::camera::CameraController cameraController;
 
     UI ui;
     std::string selectedEntity;
     bool showUI;
+    bool timeFirstFrame;
 
 public:
-    explicit SceneWindow(const std::string &sceneFile);
+    SceneWindow(const std::string &sceneFile,
+                render::InstanceBatcher::DepthPrepass depthPrepass,
+                bool _timeFirstFrame);
     SceneWindow(const SceneWindow &window) = delete;
     SceneWindow(SceneWindow &&window) = delete;
 
@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include "engine/render/InstanceBatcher.hpp"
 #include "engine/scene/camera/Camera.hpp"
 #include "engine/window/FPSCounter.hpp"
 #include "engine/window/Window.hpp"
@@ -23,17 +24,21 @@ namespace engine::window {
 class UI {
 private:
     scene::camera::Camera &camera;
+    render::InstanceBatcher &instanceBatcher;
     FPSCounter fpsCounter;
     int entityCount;
     bool fillPolygons, backFaceCulling, showAxes, showBoundingSpheres, showAnimationLines,
-        showNormals;
+        showNormals, occlusionCulling;
 
 public:
-    UI(const Window &window, scene::camera::Camera &_camera, int _entityCount);
+    UI(const Window &window,
+       scene::camera::Camera &_camera,
+       render::InstanceBatcher &_instanceBatcher,
+       int _entityCount);
     ~UI();
 
     bool isCapturingKeyboard() const;
-    void draw(int renderedEntities, const std::string &selectedEntity);
+    void draw(int renderedEntities, int occludedEntities, const std::string &selectedEntity);
 
     bool shouldFillPolygons() const;
     bool shouldCullBackFaces() const;
@@ -41,6 +46,7 @@ public:
     bool shouldShowBoundingSpheres() const;
     bool shouldShowAnimationLines() const;
     bool shouldShowNormals() const;
+    bool shouldCullOccluded() const;
 };
 
 }
@@ -36,7 +36,7 @@ public:
                          float gasScale = 1.0f,
                          float _timeScale = 1.0f);
 
-    void writeToFile(const std::string &dirname);
+    void writeToFile(const std::string &dirname, int precision = 6);
 
 private:
     tinyxml2::XMLElement *createVector(const std::string &name, const glm::vec3 &vec);
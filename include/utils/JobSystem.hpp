@@ -0,0 +1,83 @@
+/// Copyright 2025 Ana Oliveira, Humberto Gomes, Mariana Rocha, Sara Lopes
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace utils {
+
+// Runs loops over ranges of indices on a pool of threads. Each thread has its own deque of ranges,
+// and ranges are split lazily: the thread running one keeps its lower half and pushes the upper
+// half to its own deque, from which idle threads steal.
+class JobSystem {
+public:
+    using RangeFunction = std::function<void(uint32_t begin, uint32_t end)>;
+
+private:
+    // Chase-Lev deque of ranges, packed as begin << 32 | end. Only its owner pushes and pops at the
+    // bottom, while other threads steal from the top.
+    class WorkQueue {
+    private:
+        static const int64_t capacity = 256;
+
+        alignas(64) std::atomic<int64_t> top;
+        alignas(64) std::atomic<int64_t> bottom;
+        std::array<std::atomic<uint64_t>, capacity> ranges;
+
+    public:
+        WorkQueue();
+
+        bool push(uint64_t range);
+        bool pop(uint64_t &range);
+        bool steal(uint64_t &range);
+    };
+
+    std::vector<std::unique_ptr<WorkQueue>> queues; // The first one is the caller's
+    std::vector<std::thread> workers;
+
+    // Of the loop being run
+    std::atomic<const RangeFunction *> function;
+    std::atomic<uint32_t> grainSize;
+    std::atomic<uint32_t> remaining;
+
+    std::atomic<uint32_t> epoch; // Changes when there's new work, for idle threads to wake up
+    std::atomic<bool> stopping;
+
+public:
+    JobSystem();
+    JobSystem(const JobSystem &jobSystem) = delete;
+    JobSystem(JobSystem &&jobSystem) = delete;
+    ~JobSystem();
+
+    // Calls function over [0, count), in ranges of at most grainSize indices, and returns when it's
+    // done. The calling thread works too. Loops can't be nested, nor run by more than one thread.
+    void parallelFor(uint32_t count, uint32_t _grainSize, const RangeFunction &_function);
+
+    int getThreadCount() const;
+
+private:
+    void work(int index);
+    bool findWork(int index, uint64_t &range);
+    void execute(int index, uint64_t range);
+    void wake();
+};
+
+}
@@ -0,0 +1,39 @@
+/// Copyright 2025 Ana Oliveira, Humberto Gomes, Mariana Rocha, Sara Lopes
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace utils {
+
+class MappedFile {
+private:
+    void *data;
+    size_t size;
+    bool open;
+
+public:
+    explicit MappedFile(const std::string &filename);
+    MappedFile(const MappedFile &file) = delete;
+    MappedFile(MappedFile &&file) = delete;
+    ~MappedFile();
+
+    bool isOpen() const;
+    const char *getData() const;
+    size_t getSize() const;
+};
+
+}
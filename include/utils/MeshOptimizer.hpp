@@ -0,0 +1,62 @@
+/// Copyright 2025 Ana Oliveira, Humberto Gomes, Mariana Rocha, Sara Lopes
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <glm/vec2.hpp>
+#include <glm/vec4.hpp>
+#include <span>
+#include <vector>
+
+namespace utils {
+
+class MeshOptimizer {
+public:
+    // Every run of this many triangles in an optimized mesh is a spatially compact cluster
+    static const uint32_t clusterSize = 128;
+
+private:
+    static const uint32_t cacheSize = 16;
+
+public:
+    static void optimize(std::vector<glm::vec4> &positions,
+                         std::vector<glm::vec2> &textureCoordinates,
+                         std::vector<glm::vec4> &normals,
+                         std::vector<uint32_t> &indices);
+
+    static float getACMR(const std::vector<uint32_t> &indices, size_t vertexCount);
+    static float getATVR(const std::vector<uint32_t> &indices, size_t vertexCount);
+
+private:
+    static std::vector<uint32_t> reorderForVertexCache(const std::vector<uint32_t> &indices,
+                                                       size_t vertexCount);
+    static std::vector<uint32_t> buildClusters(const std::vector<glm::vec4> &positions,
+                                               const std::vector<uint32_t> &indices);
+    static std::vector<uint32_t> reorderForOverdraw(const std::vector<glm::vec4> &positions,
+                                                    const std::vector<uint32_t> &indices);
+    static void reorderForVertexFetch(std::vector<glm::vec4> &positions,
+                                      std::vector<glm::vec2> &textureCoordinates,
+                                      std::vector<glm::vec4> &normals,
+                                      std::vector<uint32_t> &indices);
+
+    static void getTriangleAdjacency(const std::vector<uint32_t> &indices,
+                                     size_t vertexCount,
+                                     std::vector<uint32_t> &adjacencyOffsets,
+                                     std::vector<uint32_t> &adjacency);
+    static size_t countCacheMisses(std::span<const uint32_t> indices, size_t vertexCount);
+};
+
+}
@@ -0,0 +1,56 @@
+/// Copyright 2025 Ana Oliveira, Humberto Gomes, Mariana Rocha, Sara Lopes
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <vector>
+
+namespace utils {
+
+class MeshSimplifier {
+private:
+    struct Quadric {
+        double a2, ab, ac, ad, b2, bc, bd, c2, cd, d2;
+    };
+
+    struct Collapse {
+        double cost;
+        uint32_t from, to;
+        uint32_t fromVersion, toVersion;
+    };
+
+    static constexpr float boundaryWeight = 10.0f;
+    static constexpr float minimumNormalCosine = 0.25f;
+
+public:
+    static std::vector<uint32_t> simplify(const std::vector<glm::vec4> &positions,
+                                          const std::vector<uint32_t> &indices,
+                                          size_t targetTriangleCount);
+
+private:
+    static std::vector<uint32_t> weldPositions(const std::vector<glm::vec4> &positions);
+    static std::vector<uint64_t> getEdges(const std::vector<uint32_t> &indices,
+                                          const std::vector<uint32_t> &positionIds);
+    static uint64_t getEdgeKey(uint32_t a, uint32_t b);
+
+    static void addPlane(Quadric &quadric, const glm::vec3 &normal, float distance, float weight);
+    static void addQuadric(Quadric &quadric, const Quadric &other);
+    static double evaluateQuadric(const Quadric &quadric, const glm::vec3 &point);
+};
+
+}
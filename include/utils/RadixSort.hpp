@@ -0,0 +1,29 @@
+/// Copyright 2025 Ana Oliveira, Humberto Gomes, Mariana Rocha, Sara Lopes
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace utils {
+
+class RadixSort {
+public:
+    // Least significant digit first, 8 bits at a time. Digits shared by all keys are skipped, so
+    // short keys are sorted in few passes.
+    static void sort(std::vector<uint64_t> &keys, std::vector<uint64_t> &scratch);
+};
+
+}
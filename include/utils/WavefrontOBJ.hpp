@@ -18,7 +18,6 @@
 #include <glm/vec2.hpp>
 #include <glm/vec3.hpp>
 #include <glm/vec4.hpp>
-#include <regex>
 #include <string>
 #include <tuple>
 #include <vector>
@@ -29,7 +28,12 @@ namespace utils {
 
 class WavefrontOBJ {
 private:
-    static std::regex lineRegex;
+    struct ParseStatistics {
+        int lineCount;
+        bool failed;
+        int32_t maxPosition, maxTextureCoordinate, maxNormal;
+        bool hasNormals, hasSimpleFaces;
+    };
 
 protected:
     std::string comment;
@@ -42,8 +46,12 @@ protected:
 
 public:
     explicit WavefrontOBJ(const std::string &filename);
+    WavefrontOBJ(const std::vector<glm::vec4> &_positions,
+                 const std::vector<glm::vec2> &_textureCoordinates,
+                 const std::vector<glm::vec4> &_normals,
+                 const std::vector<uint32_t> &indices);
 
-    void writeToFile(const std::string &filename) const;
+    void writeToFile(const std::string &filename, int precision = 6) const;
     std::tuple<std::vector<glm::vec4>, // Positions
                std::vector<glm::vec2>, // Texture coordinates
                std::vector<glm::vec4>, // Normals (padded)
@@ -51,7 +59,16 @@ public:
         getIndexedVertices() const;
 
 private:
+    ParseStatistics parseLines(const char *begin, const char *end);
+    ParseStatistics parseLinesInParallel(const char *begin, const char *end, unsigned int threads);
+    bool parseLine(const char *line, const char *end, ParseStatistics &statistics);
     void generateNormals();
+
+    static bool skipWhitespace(const char *&cursor, const char *end);
+    static bool parseFloat(const char *&cursor, const char *end, float &value);
+    static bool parseIndex(const char *&cursor, const char *end, int32_t &index);
+    static void formatFloat(std::string &buffer, float value, int precision);
+    static void formatIndex(std::string &buffer, int32_t index);
 };
 
 }
@@ -13,19 +13,50 @@
 /// limitations under the License.
 
 #include <iostream>
+#include <string>
+#include <vector>
 
+#include "engine/render/InstanceBatcher.hpp"
 #include "engine/scene/Scene.hpp"
 #include "engine/window/SceneWindow.hpp"
 
 namespace engine {
 
 int main(int argc, char **argv) {
-    if (argc <= 1) {
-        std::cerr << "Usage: " << argv[0] << " <scene.xml>" << std::endl;
+    std::vector<std::string> args(argv, argv + argc);
+
+    bool validArguments = true;
+    render::InstanceBatcher::DepthPrepass depthPrepass =
+        render::InstanceBatcher::DepthPrepass::Automatic;
+    bool timeFirstFrame = false;
+
+    while (validArguments && args.size() > 2) {
+        if (args[1] == "--depth-prepass") {
+            if (args[2] == "on") {
+                depthPrepass = render::InstanceBatcher::DepthPrepass::Enabled;
+            } else if (args[2] == "off") {
+                depthPrepass = render::InstanceBatcher::DepthPrepass::Disabled;
+            } else if (args[2] != "auto") {
+                validArguments = false;
+            }
+
+            args.erase(args.begin() + 1, args.begin() + 3);
+        } else if (args[1] == "--time-first-frame") {
+            timeFirstFrame = true;
+            args.erase(args.begin() + 1);
+        } else {
+            validArguments = false;
+        }
+    }
+
+    if (!validArguments || args.size() != 2) {
+        std::cerr << "Usage: " << argv[0]
+                  << " [--depth-prepass on|off|auto] [--time-first-frame] <scene.xml>"
+                  << std::endl;
         return 1;
     }
 
-    window::SceneWindow _window(argv[1]);
+    window::SceneWindow _window(args[1], depthPrepass, timeFirstFrame);
     _window.runLoop();
     return 0;
 }
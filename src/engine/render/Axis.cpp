@@ -46,7 +46,7 @@ void Axis::draw(RenderPipelineManager &pipelineManager, const glm::mat4 &cameraM
     shader.setFullMatrix(cameraMatrix);
     shader.setColor(this->color);
 
-    glBindVertexArray(this->vao);
+    pipelineManager.bindVertexArray(this->vao);
     glDrawArrays(GL_LINES, 0, 2);
 }
 
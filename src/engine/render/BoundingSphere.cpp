@@ -46,15 +46,15 @@ BoundingSphere::BoundingSphere(const BoundingSphere &sphere, const glm::mat4 &tr
     this->center = transform * sphere.center;
 }
 
-BoundingSphere::BoundingSphere(const std::vector<glm::vec4> &vertices) : BoundingSphere() {
+BoundingSphere::BoundingSphere(std::span<const glm::vec4> vertices) : BoundingSphere() {
     // Calculate center of mass
-    this->center = std::reduce(vertices.cbegin(), vertices.cend(), glm::vec4(0.0f), std::plus<>()) /
+    this->center = std::reduce(vertices.begin(), vertices.end(), glm::vec4(0.0f), std::plus<>()) /
         static_cast<float>(vertices.size());
 
     // Calculate radius
     this->radius = std::transform_reduce(
-        vertices.cbegin(),
-        vertices.cend(),
+        vertices.begin(),
+        vertices.end(),
         -1.0,
         [](float d1, float d2) { return std::max(d1, d2); },
         [this](const glm::vec4 &vertex) { return glm::distance(this->center, vertex); });
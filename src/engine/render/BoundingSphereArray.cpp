@@ -0,0 +1,162 @@
+/// Copyright 2025 Ana Oliveira, Humberto Gomes, Mariana Rocha, Sara Lopes
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+
+#include <limits>
+
+#ifdef __x86_64__
+#include <immintrin.h>
+#endif
+
+#include "engine/render/BoundingSphereArray.hpp"
+
+namespace engine::render {
+
+BoundingSphereArray::BoundingSphereArray() : count(0), avx2(false), avx512(false) {
+#ifdef __x86_64__
+    this->avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    this->avx512 = __builtin_cpu_supports("avx512f");
+#endif
+}
+
+void BoundingSphereArray::resize(size_t _count) {
+    this->count = _count;
+
+    // Padding spheres have a negative infinite radius, so they're behind every plane
+    const size_t padded =
+        (_count + BoundingSphereArray::padding - 1) / BoundingSphereArray::padding *
+        BoundingSphereArray::padding;
+    this->centersX.assign(padded, 0.0f);
+    this->centersY.assign(padded, 0.0f);
+    this->centersZ.assign(padded, 0.0f);
+    this->radii.assign(padded, -std::numeric_limits<float>::infinity());
+}
+
+size_t BoundingSphereArray::size() const {
+    return this->count;
+}
+
+BoundingSphere BoundingSphereArray::get(size_t index) const {
+    return BoundingSphere(
+        glm::vec4(this->centersX[index], this->centersY[index], this->centersZ[index], 1.0f),
+        this->radii[index]);
+}
+
+void BoundingSphereArray::set(size_t index, const BoundingSphere &sphere) {
+    const glm::vec4 &center = sphere.getCenter();
+    this->centersX[index] = center.x;
+    this->centersY[index] = center.y;
+    this->centersZ[index] = center.z;
+    this->radii[index] = sphere.getRadius();
+}
+
+void BoundingSphereArray::cull(std::span<const glm::vec4, 6> planes,
+                               std::vector<uint64_t> &visibility) const {
+
+    // Padding is a multiple of 8 and 16 spheres, so no register is ever split between two words
+    visibility.assign((this->radii.size() + 63) / 64, 0);
+
+    if (this->avx512) {
+        this->cullAVX512(planes, visibility.data());
+    } else if (this->avx2) {
+        this->cullAVX2(planes, visibility.data());
+    } else {
+        this->cullScalar(planes, visibility.data());
+    }
+}
+
+bool BoundingSphereArray::isVisible(const std::vector<uint64_t> &visibility, size_t index) {
+    return (visibility[index / 64] >> (index % 64)) & 1;
+}
+
+void BoundingSphereArray::cullScalar(std::span<const glm::vec4, 6> planes,
+                                     uint64_t *visibility) const {
+
+    for (size_t i = 0; i < this->count; ++i) {
+        bool visible = true;
+        for (const glm::vec4 &plane : planes) {
+            const float distance = plane.x * this->centersX[i] + plane.y * this->centersY[i] +
+                plane.z * this->centersZ[i] + plane.w;
+
+            if (distance < -this->radii[i]) {
+                visible = false;
+                break;
+            }
+        }
+
+        visibility[i / 64] |= static_cast<uint64_t>(visible) << (i % 64);
+    }
+}
+
+#ifdef __x86_64__
+__attribute__((target("avx2,fma"))) void BoundingSphereArray::cullAVX2(
+    std::span<const glm::vec4, 6> planes,
+    uint64_t *visibility) const {
+
+    for (size_t i = 0; i < this->radii.size(); i += 8) {
+        const __m256 x = _mm256_loadu_ps(&this->centersX[i]);
+        const __m256 y = _mm256_loadu_ps(&this->centersY[i]);
+        const __m256 z = _mm256_loadu_ps(&this->centersZ[i]);
+        const __m256 negativeRadius =
+            _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(&this->radii[i]));
+
+        __m256 visible = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (const glm::vec4 &plane : planes) {
+            __m256 distance = _mm256_fmadd_ps(_mm256_set1_ps(plane.x), x, _mm256_set1_ps(plane.w));
+            distance = _mm256_fmadd_ps(_mm256_set1_ps(plane.y), y, distance);
+            distance = _mm256_fmadd_ps(_mm256_set1_ps(plane.z), z, distance);
+
+            visible = _mm256_and_ps(visible, _mm256_cmp_ps(distance, negativeRadius, _CMP_NLT_UQ));
+        }
+
+        const uint64_t mask = static_cast<uint32_t>(_mm256_movemask_ps(visible));
+        visibility[i / 64] |= mask << (i % 64);
+    }
+}
+
+__attribute__((target("avx512f"))) void BoundingSphereArray::cullAVX512(
+    std::span<const glm::vec4, 6> planes,
+    uint64_t *visibility) const {
+
+    for (size_t i = 0; i < this->radii.size(); i += 16) {
+        const __m512 x = _mm512_loadu_ps(&this->centersX[i]);
+        const __m512 y = _mm512_loadu_ps(&this->centersY[i]);
+        const __m512 z = _mm512_loadu_ps(&this->centersZ[i]);
+        const __m512 negativeRadius =
+            _mm512_sub_ps(_mm512_setzero_ps(), _mm512_loadu_ps(&this->radii[i]));
+
+        __mmask16 visible = 0xFFFF;
+        for (const glm::vec4 &plane : planes) {
+            __m512 distance = _mm512_fmadd_ps(_mm512_set1_ps(plane.x), x, _mm512_set1_ps(plane.w));
+            distance = _mm512_fmadd_ps(_mm512_set1_ps(plane.y), y, distance);
+            distance = _mm512_fmadd_ps(_mm512_set1_ps(plane.z), z, distance);
+
+            visible = _mm512_mask_cmp_ps_mask(visible, distance, negativeRadius, _CMP_NLT_UQ);
+        }
+
+        visibility[i / 64] |= static_cast<uint64_t>(visible) << (i % 64);
+    }
+}
+#else
+void BoundingSphereArray::cullAVX2(std::span<const glm::vec4, 6> planes,
+                                   uint64_t *visibility) const {
+    this->cullScalar(planes, visibility);
+}
+
+void BoundingSphereArray::cullAVX512(std::span<const glm::vec4, 6> planes,
+                                     uint64_t *visibility) const {
+    this->cullScalar(planes, visibility);
+}
+#endif
+
+}
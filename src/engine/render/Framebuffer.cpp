@@ -21,12 +21,11 @@ Framebuffer::Framebuffer(int _width, int _height) : width(_width), height(_heigh
     glGenFramebuffers(1, &this->fbo);
     glBindFramebuffer(GL_FRAMEBUFFER, this->fbo);
 
-    // Create color attachment
-    glGenTextures(1, &this->colorTexture);
-    glBindTexture(GL_TEXTURE_2D, this->colorTexture);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, _width, _height, 0, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+    // Create color attachment (without binding it, as RenderPipelineManager tracks textures)
+    glCreateTextures(GL_TEXTURE_2D, 1, &this->colorTexture);
+    glTextureParameteri(this->colorTexture, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTextureParameteri(this->colorTexture, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTextureStorage2D(this->colorTexture, 1, GL_RGB8, _width, _height);
 
     glFramebufferTexture2D(GL_FRAMEBUFFER,
                            GL_COLOR_ATTACHMENT0,
@@ -0,0 +1,243 @@
+/// Copyright 2025 Ana Oliveira, Humberto Gomes, Mariana Rocha, Sara Lopes
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <vector>
+
+#include "engine/render/GeometryArena.hpp"
+
+namespace engine::render {
+
+GeometryArena::GeometryArena(VertexFormat _vertexFormat) :
+    vertexFormat(_vertexFormat),
+    vertexSize(_vertexFormat == VertexFormat::Float32 ? sizeof(FloatVertex)
+                                                      : sizeof(QuantizedVertex)),
+    vbo(GeometryArena::createBuffer(GeometryArena::initialVertexCapacity * this->vertexSize)),
+    ibo(GeometryArena::createBuffer(GeometryArena::initialIndexCapacity)),
+    vertexCapacity(GeometryArena::initialVertexCapacity),
+    indexCapacity(GeometryArena::initialIndexCapacity),
+    freeVertices({ { 0, GeometryArena::initialVertexCapacity } }),
+    freeIndices({ { 0, GeometryArena::initialIndexCapacity } }) {
+
+    glGenVertexArrays(1, &this->vao);
+    glBindVertexArray(this->vao);
+
+    if (this->vertexFormat == VertexFormat::Float32) {
+        this->initializeAttribute(0, 4, GL_FLOAT, false, offsetof(FloatVertex, position));
+        this->initializeAttribute(1,
+                                  2,
+                                  GL_FLOAT,
+                                  false,
+                                  offsetof(FloatVertex, textureCoordinate));
+        this->initializeAttribute(2, 3, GL_FLOAT, false, offsetof(FloatVertex, normal));
+    } else {
+        // Half-precision values aren't normalized, while 16-bit integers are
+        const bool half = this->vertexFormat == VertexFormat::Float16;
+
+        this->initializeAttribute(0,
+                                  4,
+                                  half ? GL_HALF_FLOAT : GL_SHORT,
+                                  !half,
+                                  offsetof(QuantizedVertex, position));
+        this->initializeAttribute(1,
+                                  2,
+                                  half ? GL_HALF_FLOAT : GL_UNSIGNED_SHORT,
+                                  !half,
+                                  offsetof(QuantizedVertex, textureCoordinate));
+        this->initializeAttribute(2, 2, GL_SHORT, true, offsetof(QuantizedVertex, normal));
+    }
+
+    this->attachBuffers();
+}
+
+GeometryArena::~GeometryArena() {
+    GLuint buffers[2] = { this->vbo, this->ibo };
+    glDeleteBuffers(2, buffers);
+    glDeleteVertexArrays(1, &this->vao);
+}
+
+GeometryArena &GeometryArena::get(VertexFormat vertexFormat) {
+    std::unique_ptr<GeometryArena> &arena = GeometryArena::arenas[static_cast<int>(vertexFormat)];
+    if (!arena) {
+        arena = std::make_unique<GeometryArena>(vertexFormat);
+    }
+    return *arena;
+}
+
+void GeometryArena::destroyAll() {
+    for (std::unique_ptr<GeometryArena> &arena : GeometryArena::arenas) {
+        arena.reset();
+    }
+}
+
+size_t GeometryArena::getIndexSize(GLenum indexType) {
+    return indexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(uint32_t);
+}
+
+GeometryArena::Allocation GeometryArena::allocate(const void *vertices,
+                                                  size_t vertexCount,
+                                                  std::span<const uint32_t> indices) {
+
+    // Indices are relative to the base vertex, so 16-bit ones are enough for most models
+    Allocation allocation;
+    allocation.vertexCount = vertexCount;
+    allocation.indexCount = indices.size();
+    allocation.indexType = vertexCount <= std::numeric_limits<uint16_t>::max() + 1u
+        ? GL_UNSIGNED_SHORT
+        : GL_UNSIGNED_INT;
+
+    const size_t indexSize = GeometryArena::getIndexSize(allocation.indexType);
+    const size_t vertexOffset = this->allocateRange(this->freeVertices,
+                                                    this->vbo,
+                                                    this->vertexCapacity,
+                                                    this->vertexSize,
+                                                    std::max<size_t>(vertexCount, 1));
+
+    const size_t indexOffset =
+        this->allocateRange(this->freeIndices,
+                            this->ibo,
+                            this->indexCapacity,
+                            1,
+                            GeometryArena::getIndexRangeSize(indices.size(), allocation.indexType));
+    this->attachBuffers();
+
+    allocation.baseVertex = vertexOffset;
+    allocation.firstIndex = indexOffset / indexSize;
+
+    // Upload data
+    glBindBuffer(GL_COPY_WRITE_BUFFER, this->vbo);
+    glBufferSubData(GL_COPY_WRITE_BUFFER,
+                    vertexOffset * this->vertexSize,
+                    vertexCount * this->vertexSize,
+                    vertices);
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, this->ibo);
+    if (allocation.indexType == GL_UNSIGNED_SHORT) {
+        const std::vector<uint16_t> shortIndices(indices.begin(), indices.end());
+        glBufferSubData(GL_COPY_WRITE_BUFFER,
+                        indexOffset,
+                        shortIndices.size() * sizeof(uint16_t),
+                        shortIndices.data());
+    } else {
+        glBufferSubData(GL_COPY_WRITE_BUFFER, indexOffset, indices.size_bytes(), indices.data());
+    }
+
+    return allocation;
+}
+
+void GeometryArena::free(const Allocation &allocation) {
+    const size_t indexSize = GeometryArena::getIndexSize(allocation.indexType);
+    GeometryArena::freeRange(this->freeVertices,
+                             allocation.baseVertex,
+                             std::max<size_t>(allocation.vertexCount, 1));
+    GeometryArena::freeRange(
+        this->freeIndices,
+        allocation.firstIndex * indexSize,
+        GeometryArena::getIndexRangeSize(allocation.indexCount, allocation.indexType));
+}
+
+GLuint GeometryArena::getVertexArray() const {
+    return this->vao;
+}
+
+void GeometryArena::initializeAttribute(GLuint attribute,
+                                        GLint components,
+                                        GLenum type,
+                                        bool normalized,
+                                        size_t offset) {
+
+    // All attributes come from the same interleaved buffer, which may be replaced when growing
+    glVertexAttribFormat(attribute, components, type, normalized, offset);
+    glVertexAttribBinding(attribute, 0);
+    glEnableVertexAttribArray(attribute);
+}
+
+void GeometryArena::attachBuffers() const {
+    glBindVertexArray(this->vao);
+    glBindVertexBuffer(0, this->vbo, 0, this->vertexSize);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->ibo);
+}
+
+size_t GeometryArena::allocateRange(std::map<size_t, size_t> &freeRanges,
+                                    GLuint &buffer,
+                                    size_t &capacity,
+                                    size_t unitSize,
+                                    size_t size) {
+
+    // First fit
+    for (auto it = freeRanges.begin(); it != freeRanges.end(); ++it) {
+        const auto [offset, rangeSize] = *it;
+        if (rangeSize >= size) {
+            freeRanges.erase(it);
+            if (rangeSize > size) {
+                freeRanges[offset + size] = rangeSize - size;
+            }
+            return offset;
+        }
+    }
+
+    // Grow the buffer (only expected while loading a scene)
+    const size_t newCapacity = std::max(capacity * 2, capacity + size);
+    const GLuint newBuffer = GeometryArena::createBuffer(newCapacity * unitSize);
+
+    glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, newBuffer);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, capacity * unitSize);
+    glDeleteBuffers(1, &buffer);
+
+    buffer = newBuffer;
+    GeometryArena::freeRange(freeRanges, capacity, newCapacity - capacity);
+    capacity = newCapacity;
+    return this->allocateRange(freeRanges, buffer, capacity, unitSize, size);
+}
+
+size_t GeometryArena::getIndexRangeSize(size_t indexCount, GLenum indexType) {
+    // Index ranges are kept aligned to 4 bytes, so that either index type can start anywhere
+    const size_t size = indexCount * GeometryArena::getIndexSize(indexType);
+    return std::max<size_t>((size + 3) & ~static_cast<size_t>(3), 4);
+}
+
+void GeometryArena::freeRange(std::map<size_t, size_t> &freeRanges, size_t offset, size_t size) {
+    // Merge with the neighboring free ranges
+    auto next = freeRanges.lower_bound(offset);
+    if (next != freeRanges.end() && offset + size == next->first) {
+        size += next->second;
+        next = freeRanges.erase(next);
+    }
+
+    if (next != freeRanges.begin()) {
+        const auto previous = std::prev(next);
+        if (previous->first + previous->second == offset) {
+            previous->second += size;
+            return;
+        }
+    }
+
+    freeRanges[offset] = size;
+}
+
+GLuint GeometryArena::createBuffer(size_t size) {
+    GLuint buffer;
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    glBufferStorage(GL_COPY_WRITE_BUFFER, size, nullptr, GL_DYNAMIC_STORAGE_BIT);
+    return buffer;
+}
+
+std::unique_ptr<GeometryArena> GeometryArena::arenas[3];
+
+}
@@ -0,0 +1,322 @@
+/// Copyright 2025 Ana Oliveira, Humberto Gomes, Mariana Rocha, Sara Lopes
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#include "engine/render/InstanceBatcher.hpp"
+#include "utils/RadixSort.hpp"
+
+namespace engine::render {
+
+InstanceBatcher::InstanceBatcher() :
+    ringBuffer(),
+    depthPrepass(DepthPrepass::Automatic),
+    usingDepthPrepass(false),
+    overdrawQueryPixels { 0, 0, 0 },
+    nextOverdrawQuery(0),
+    overdraw(0.0f) {
+
+    glGenQueries(InstanceBatcher::overdrawQueryCount, this->overdrawQueries);
+}
+
+InstanceBatcher::~InstanceBatcher() {
+    glDeleteQueries(InstanceBatcher::overdrawQueryCount, this->overdrawQueries);
+}
+
+void InstanceBatcher::add(const Model &model,
+                          const std::shared_ptr<Texture> texture,
+                          uint32_t materialIndex,
+                          const glm::mat4 &fullMatrix,
+                          const glm::mat4 &worldMatrix,
+                          const glm::mat4 &normalMatrix) {
+
+    // View depth of the model's center, for front to back ordering
+    const float depth = (fullMatrix * model.getBoundingSphere().getCenter()).w;
+
+    const uint32_t batchIndex = this->getBatch(model, texture);
+    Batch &batch = this->batches[batchIndex];
+    batch.instanceCount++;
+    batch.depth = std::min(batch.depth, depth);
+    batch.fullMatrix = fullMatrix;
+
+    this->instances.push_back({ worldMatrix, normalMatrix, materialIndex, { 0, 0, 0 } });
+    this->instanceBatches.push_back(batchIndex);
+}
+
+void InstanceBatcher::draw(RenderPipelineManager &pipelineManager) {
+    // Make the instances of each batch contiguous (counting sort)
+    uint32_t firstInstance = 0;
+    for (Batch &batch : this->batches) {
+        batch.firstInstance = firstInstance;
+        firstInstance += batch.instanceCount;
+        batch.instanceCount = 0;
+    }
+
+    this->buildCommands(pipelineManager);
+    if (this->commands.empty()) {
+        this->clear();
+        return;
+    }
+
+    // Write everything needed for the frame into the ring buffer
+    const size_t instancesSize = this->instances.size() * sizeof(Instance);
+    const size_t drawsSize = this->draws.size() * sizeof(Draw);
+    const size_t commandsSize = this->commands.size() * sizeof(GeometryArena::DrawCommand);
+    this->ringBuffer.beginFrame(this->ringBuffer.getAlignedSize(instancesSize) +
+                                this->ringBuffer.getAlignedSize(drawsSize) + commandsSize);
+
+    void *instancesData, *drawsData, *commandsData;
+    const size_t instancesOffset = this->ringBuffer.allocate(instancesSize, instancesData);
+    const size_t drawsOffset = this->ringBuffer.allocate(drawsSize, drawsData);
+    const size_t commandsOffset = this->ringBuffer.allocate(commandsSize, commandsData);
+
+    Instance *sortedInstances = static_cast<Instance *>(instancesData);
+    for (size_t i = 0; i < this->instances.size(); ++i) {
+        Batch &batch = this->batches[this->instanceBatches[i]];
+        sortedInstances[batch.firstInstance + batch.instanceCount++] = this->instances[i];
+    }
+    std::memcpy(drawsData, this->draws.data(), drawsSize);
+    std::memcpy(commandsData, this->commands.data(), commandsSize);
+
+    const GLuint buffer = this->ringBuffer.getBuffer();
+    glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 0, buffer, instancesOffset, instancesSize);
+    glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 1, buffer, drawsOffset, drawsSize);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, buffer);
+
+    // Submit. Overdraw is measured on the pass that tests for a lower depth.
+    pipelineManager.setFillPolygons(true);
+    const bool measuringOverdraw = this->beginOverdrawQuery();
+
+    if (this->usingDepthPrepass) {
+        // The shaded pass then only runs once per pixel, as only the visible fragments have an
+        // equal depth
+        glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+        this->submit(pipelineManager, commandsOffset, true);
+        if (measuringOverdraw) {
+            this->endOverdrawQuery();
+        }
+
+        glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+        glDepthFunc(GL_EQUAL);
+        glDepthMask(GL_FALSE);
+        this->submit(pipelineManager, commandsOffset, false);
+        glDepthFunc(GL_LESS);
+        glDepthMask(GL_TRUE);
+    } else {
+        this->submit(pipelineManager, commandsOffset, false);
+        if (measuringOverdraw) {
+            this->endOverdrawQuery();
+        }
+    }
+
+    this->ringBuffer.endFrame();
+    this->clear();
+}
+
+void InstanceBatcher::setDepthPrepass(DepthPrepass mode) {
+    if (mode != this->depthPrepass) {
+        this->depthPrepass = mode;
+        this->usingDepthPrepass = mode == DepthPrepass::Enabled ||
+            (mode == DepthPrepass::Automatic &&
+             this->overdraw > InstanceBatcher::enablePrepassOverdraw);
+    }
+}
+
+InstanceBatcher::DepthPrepass InstanceBatcher::getDepthPrepass() const {
+    return this->depthPrepass;
+}
+
+bool InstanceBatcher::isUsingDepthPrepass() const {
+    return this->usingDepthPrepass;
+}
+
+float InstanceBatcher::getOverdraw() const {
+    return this->overdraw;
+}
+
+void InstanceBatcher::submit(RenderPipelineManager &pipelineManager,
+                             size_t commandsOffset,
+                             bool depthOnly) {
+
+    for (const Submission &submission : this->submissions) {
+        if (submission.commandCount == 0) {
+            continue;
+        }
+
+        pipelineManager.bindVertexArray(submission.arena->getVertexArray());
+        if (depthOnly) {
+            pipelineManager.getDepthShaderProgram().setFirstDraw(submission.firstCommand);
+        } else {
+            pipelineManager.getShadedShaderProgram().setFirstDraw(submission.firstCommand);
+            if (submission.texture) {
+                pipelineManager.useTexture(*submission.texture);
+            }
+        }
+
+        const size_t offset =
+            commandsOffset + submission.firstCommand * sizeof(GeometryArena::DrawCommand);
+        glMultiDrawElementsIndirect(GL_TRIANGLES,
+                                    submission.indexType,
+                                    reinterpret_cast<const void *>(offset),
+                                    submission.commandCount,
+                                    0);
+    }
+}
+
+bool InstanceBatcher::beginOverdrawQuery() {
+    const int index = this->nextOverdrawQuery;
+    const GLuint query = this->overdrawQueries[index];
+
+    // Skip measuring this frame rather than waiting for an old query
+    if (this->overdrawQueryPixels[index] != 0) {
+        GLint available;
+        glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) {
+            return false;
+        }
+
+        GLuint64 samples;
+        glGetQueryObjectui64v(query, GL_QUERY_RESULT, &samples);
+        this->overdraw = static_cast<float>(samples) / this->overdrawQueryPixels[index];
+        this->overdrawQueryPixels[index] = 0;
+
+        if (this->depthPrepass == DepthPrepass::Automatic) {
+            if (this->overdraw > InstanceBatcher::enablePrepassOverdraw) {
+                this->usingDepthPrepass = true;
+            } else if (this->overdraw < InstanceBatcher::disablePrepassOverdraw) {
+                this->usingDepthPrepass = false;
+            }
+        }
+    }
+
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    if (viewport[2] <= 0 || viewport[3] <= 0) {
+        return false; // Minimized window
+    }
+
+    this->overdrawQueryPixels[index] = viewport[2] * viewport[3];
+    glBeginQuery(GL_SAMPLES_PASSED, query);
+    return true;
+}
+
+void InstanceBatcher::endOverdrawQuery() {
+    glEndQuery(GL_SAMPLES_PASSED);
+    this->nextOverdrawQuery = (this->nextOverdrawQuery + 1) % InstanceBatcher::overdrawQueryCount;
+}
+
+void InstanceBatcher::clear() {
+    this->batches.clear();
+    this->modelBatches.clear();
+    this->textureIds.clear();
+    this->instances.clear();
+    this->instanceBatches.clear();
+    this->commands.clear();
+    this->draws.clear();
+    this->submissions.clear();
+}
+
+uint32_t InstanceBatcher::getBatch(const Model &model, const std::shared_ptr<Texture> texture) {
+    std::vector<uint32_t> &candidates = this->modelBatches[&model];
+    for (uint32_t candidate : candidates) {
+        if (this->batches[candidate].texture == texture) {
+            return candidate;
+        }
+    }
+
+    // Batch indices must fit in their field of the sort keys
+    if (this->batches.size() > InstanceBatcher::batchMask) {
+        throw std::runtime_error("Too many instance batches in a frame");
+    }
+
+    // Textures are numbered in order of appearance, with 0 meaning no texture
+    uint32_t textureId = 0;
+    if (texture) {
+        textureId = this->textureIds.emplace(texture.get(), this->textureIds.size() + 1)
+                        .first->second;
+    }
+
+    this->batches.push_back({ &model,
+                              texture,
+                              0,
+                              0,
+                              textureId,
+                              std::numeric_limits<float>::infinity(),
+                              glm::mat4(1.0f) });
+    candidates.push_back(this->batches.size() - 1);
+    return this->batches.size() - 1;
+}
+
+void InstanceBatcher::buildCommands(const RenderPipelineManager &pipelineManager) {
+    // Sort batches so that the commands of each submission are contiguous, front to back
+    this->keys.clear();
+    for (uint32_t i = 0; i < this->batches.size(); ++i) {
+        this->keys.push_back(this->getSortKey(i));
+    }
+    utils::RadixSort::sort(this->keys, this->sortScratch);
+
+    for (uint64_t key : this->keys) {
+        const Batch &batch = this->batches[key & InstanceBatcher::batchMask];
+        const GeometryArena *arena = &batch.model->getArena();
+        const GLenum indexType = batch.model->getIndexType();
+        const Texture *texture = batch.texture.get();
+
+        if (this->submissions.empty() || this->submissions.back().arena != arena ||
+            this->submissions.back().indexType != indexType ||
+            this->submissions.back().texture != texture) {
+
+            this->submissions.push_back(
+                { arena, indexType, texture, static_cast<uint32_t>(this->commands.size()), 0 });
+        }
+
+        // Clusters of lone instances are culled against that instance's matrix
+        batch.model->getDrawCommands(pipelineManager,
+                                     batch.fullMatrix,
+                                     batch.firstInstance,
+                                     batch.instanceCount,
+                                     this->commands);
+
+        this->draws.resize(this->commands.size(), InstanceBatcher::getDraw(batch));
+        this->submissions.back().commandCount =
+            this->commands.size() - this->submissions.back().firstCommand;
+    }
+}
+
+uint64_t InstanceBatcher::getSortKey(uint32_t batchIndex) const {
+    const Batch &batch = this->batches[batchIndex];
+
+    // The bits of non-negative floats sort like the floats themselves
+    const uint64_t vertexFormat = static_cast<uint64_t>(batch.model->getVertexFormat());
+    const uint64_t longIndices = batch.model->getIndexType() == GL_UNSIGNED_INT;
+    const uint64_t texture = std::min<uint64_t>(batch.textureId, 0xffff);
+    const uint64_t depth = std::bit_cast<uint32_t>(std::max(batch.depth, 0.0f)) >> 7;
+
+    return vertexFormat << 62 | longIndices << 61 | texture << 45 | depth << 21 | batchIndex;
+}
+
+InstanceBatcher::Draw InstanceBatcher::getDraw(const Batch &batch) {
+    Draw draw;
+    draw.positionDecodeMatrix = batch.model->getPositionDecodeMatrix();
+    draw.textureCoordinateDecode = batch.model->getTextureCoordinateDecode();
+    draw.textured = batch.texture != nullptr;
+    draw.octahedralNormals = batch.model->getVertexFormat() != VertexFormat::Float32;
+    draw.padding[0] = draw.padding[1] = 0;
+    return draw;
+}
+
+}
@@ -0,0 +1,190 @@
+/// Copyright 2025 Ana Oliveira, Humberto Gomes, Mariana Rocha, Sara Lopes
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <glad/glad.h>
+
+#include "engine/render/LightGrid.hpp"
+
+namespace engine::render {
+
+LightGrid::LightGrid() : clusters(LightGrid::clusterCount), ringBuffer(), uploaded(false) {}
+
+void LightGrid::clearLights() {
+    this->spheres.clear();
+    this->lightIndices.clear();
+}
+
+void LightGrid::addLight(uint32_t lightIndex, const glm::vec3 &position, float range) {
+    this->spheres.push_back(glm::vec4(position, range));
+    this->lightIndices.push_back(lightIndex);
+}
+
+void LightGrid::update(const glm::mat4 &viewMatrix,
+                       const glm::mat4 &projectionMatrix,
+                       float near,
+                       float far) {
+
+    // Count the lights in each cluster
+    const glm::vec2 sliceTransform = LightGrid::getSliceTransform(near, far);
+    std::fill(this->clusters.begin(), this->clusters.end(), Cluster { 0, 0 });
+    this->lightCells.clear();
+
+    for (const glm::vec4 &sphere : this->spheres) {
+        const Cells cells =
+            LightGrid::getCells(sphere, viewMatrix, projectionMatrix, near, far, sliceTransform);
+        this->lightCells.push_back(cells);
+
+        for (int slice = cells.firstSlice; slice <= cells.lastSlice; ++slice) {
+            for (int row = cells.firstRow; row <= cells.lastRow; ++row) {
+                for (int column = cells.firstColumn; column <= cells.lastColumn; ++column) {
+                    this->clusters[LightGrid::getClusterIndex(column, row, slice)].lightCount++;
+                }
+            }
+        }
+    }
+
+    // Give each cluster its range of the light index list, and fill it
+    uint32_t firstLight = 0;
+    for (Cluster &cluster : this->clusters) {
+        cluster.firstLight = firstLight;
+        firstLight += cluster.lightCount;
+        cluster.lightCount = 0;
+    }
+    this->clusterLights.resize(firstLight);
+
+    for (size_t i = 0; i < this->lightCells.size(); ++i) {
+        const Cells &cells = this->lightCells[i];
+        for (int slice = cells.firstSlice; slice <= cells.lastSlice; ++slice) {
+            for (int row = cells.firstRow; row <= cells.lastRow; ++row) {
+                for (int column = cells.firstColumn; column <= cells.lastColumn; ++column) {
+                    const int clusterIndex = LightGrid::getClusterIndex(column, row, slice);
+                    Cluster &cluster = this->clusters[clusterIndex];
+                    this->clusterLights[cluster.firstLight + cluster.lightCount++] =
+                        this->lightIndices[i];
+                }
+            }
+        }
+    }
+
+    // The previous clusters were used by every draw since the last update
+    if (this->uploaded) {
+        this->ringBuffer.endFrame();
+    }
+
+    const size_t clustersSize = this->clusters.size() * sizeof(Cluster);
+    const size_t lightsSize = this->clusterLights.size() * sizeof(uint32_t);
+    this->ringBuffer.beginFrame(clustersSize + lightsSize);
+
+    void *data;
+    const size_t offset = this->ringBuffer.allocate(clustersSize + lightsSize, data);
+    std::memcpy(data, this->clusters.data(), clustersSize);
+    std::memcpy(static_cast<char *>(data) + clustersSize, this->clusterLights.data(), lightsSize);
+
+    glBindBufferRange(GL_SHADER_STORAGE_BUFFER,
+                      4,
+                      this->ringBuffer.getBuffer(),
+                      offset,
+                      clustersSize + lightsSize);
+    this->uploaded = true;
+}
+
+glm::vec2 LightGrid::getSliceTransform(float near, float far) {
+    const float scale = LightGrid::slices / std::log(far / near);
+    return glm::vec2(scale, -std::log(near) * scale);
+}
+
+LightGrid::Cells LightGrid::getCells(const glm::vec4 &sphere,
+                                     const glm::mat4 &viewMatrix,
+                                     const glm::mat4 &projectionMatrix,
+                                     float near,
+                                     float far,
+                                     const glm::vec2 &sliceTransform) {
+
+    const glm::vec3 center = glm::vec3(viewMatrix * glm::vec4(glm::vec3(sphere), 1.0f));
+    const float radius = sphere.w;
+    const float nearestDepth = -center.z - radius, farthestDepth = -center.z + radius;
+
+    Cells cells = { 0, LightGrid::columns - 1, 0, LightGrid::rows - 1, 0, -1 };
+    if (farthestDepth < near || nearestDepth > far) {
+        return cells;
+    }
+
+    // Lights crossing the near plane may reach any part of the screen. Otherwise, use the bounds
+    // of the projection of the sphere's bounding box.
+    if (nearestDepth > near) {
+        const bool visible = LightGrid::getTiles(center.x - radius,
+                                                 center.x + radius,
+                                                 nearestDepth,
+                                                 farthestDepth,
+                                                 projectionMatrix[0][0],
+                                                 LightGrid::columns,
+                                                 cells.firstColumn,
+                                                 cells.lastColumn) &&
+            LightGrid::getTiles(center.y - radius,
+                                center.y + radius,
+                                nearestDepth,
+                                farthestDepth,
+                                projectionMatrix[1][1],
+                                LightGrid::rows,
+                                cells.firstRow,
+                                cells.lastRow);
+
+        if (!visible) {
+            return cells;
+        }
+    }
+
+    cells.firstSlice = LightGrid::getSlice(std::max(nearestDepth, near), sliceTransform);
+    cells.lastSlice = LightGrid::getSlice(std::min(farthestDepth, far), sliceTransform);
+    return cells;
+}
+
+bool LightGrid::getTiles(float low,
+                         float high,
+                         float nearestDepth,
+                         float farthestDepth,
+                         float scale,
+                         int tiles,
+                         int &first,
+                         int &last) {
+
+    // Dividing by either depth may give the extreme, depending on the sign
+    const float lowNDC = scale * std::min(low / nearestDepth, low / farthestDepth);
+    const float highNDC = scale * std::max(high / nearestDepth, high / farthestDepth);
+    if (lowNDC > 1.0f || highNDC < -1.0f) {
+        return false;
+    }
+
+    first = static_cast<int>(std::floor((lowNDC * 0.5f + 0.5f) * tiles));
+    last = static_cast<int>(std::floor((highNDC * 0.5f + 0.5f) * tiles));
+    first = std::clamp(first, 0, tiles - 1);
+    last = std::clamp(last, 0, tiles - 1);
+    return true;
+}
+
+int LightGrid::getSlice(float depth, const glm::vec2 &sliceTransform) {
+    // Same as in ShadedShaderProgram
+    const int slice =
+        static_cast<int>(std::floor(std::log(depth) * sliceTransform.x + sliceTransform.y));
+    return std::clamp(slice, 0, LightGrid::slices - 1);
+}
+
+int LightGrid::getClusterIndex(int column, int row, int slice) {
+    return (slice * LightGrid::rows + row) * LightGrid::columns + column;
+}
+
+}
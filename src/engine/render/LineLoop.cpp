@@ -45,7 +45,7 @@ void LineLoop::draw(RenderPipelineManager &pipelineManager,
     shader.setFullMatrix(fullMatrix);
     shader.setColor(color);
 
-    glBindVertexArray(this->vao);
+    pipelineManager.bindVertexArray(this->vao);
     glDrawArrays(GL_LINE_LOOP, 0, this->pointCount);
 }
 
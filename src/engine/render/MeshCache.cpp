@@ -0,0 +1,213 @@
+/// Copyright 2025 Ana Oliveira, Humberto Gomes, Mariana Rocha, Sara Lopes
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <tuple>
+
+#include "engine/render/MeshCache.hpp"
+#include "utils/MeshOptimizer.hpp"
+
+namespace engine::render {
+
+MeshCache::MeshCache(const std::string &modelPath) {
+    const std::string cachePath = modelPath + ".meshcache";
+    const uint64_t sourceSize = std::filesystem::file_size(modelPath);
+    const int64_t sourceModificationTime =
+        std::filesystem::last_write_time(modelPath).time_since_epoch().count();
+
+    if (this->load(cachePath, modelPath, sourceSize, sourceModificationTime)) {
+        return;
+    }
+
+    this->build(utils::WavefrontOBJ(modelPath));
+
+    // Failing to store the cache (e.g.: read-only directory) only makes the next start slower
+    try {
+        this->write(cachePath, sourceSize, sourceModificationTime, MeshCache::hashFile(modelPath));
+    } catch (const std::exception &) {
+        std::error_code error;
+        std::filesystem::remove(cachePath + ".tmp", error);
+    }
+}
+
+MeshCache::MeshCache(const utils::WavefrontOBJ &object) {
+    this->build(object);
+}
+
+std::span<const glm::vec4> MeshCache::getPositions() const {
+    return this->positions;
+}
+
+std::span<const glm::vec2> MeshCache::getTextureCoordinates() const {
+    return this->textureCoordinates;
+}
+
+std::span<const glm::vec4> MeshCache::getNormals() const {
+    return this->normals;
+}
+
+std::span<const uint32_t> MeshCache::getIndices() const {
+    return this->indices;
+}
+
+const BoundingSphere &MeshCache::getBoundingSphere() const {
+    return this->boundingSphere;
+}
+
+bool MeshCache::load(const std::string &cachePath,
+                     const std::string &modelPath,
+                     uint64_t sourceSize,
+                     int64_t sourceModificationTime) {
+
+    this->file = std::make_unique<utils::MappedFile>(cachePath);
+    if (!this->file->isOpen() || this->file->getSize() < sizeof(Header)) {
+        this->file.reset();
+        return false;
+    }
+
+    Header header;
+    std::memcpy(&header, this->file->getData(), sizeof(Header));
+
+    // Counts in a corrupt cache could be large enough for the expected size to overflow
+    const size_t vertexSize = 2 * sizeof(glm::vec4) + sizeof(glm::vec2);
+    const size_t dataSize = this->file->getSize() - sizeof(Header);
+    if (header.vertexCount > dataSize / vertexSize ||
+        header.indexCount > dataSize / sizeof(uint32_t)) {
+
+        this->file.reset();
+        return false;
+    }
+
+    const size_t expectedSize = sizeof(Header) + header.vertexCount * vertexSize +
+        header.indexCount * sizeof(uint32_t);
+
+    // A different modification time alone (e.g.: after a checkout) doesn't invalidate the cache
+    if (std::memcmp(header.magic, MeshCache::magic, sizeof(MeshCache::magic)) != 0 ||
+        header.version != MeshCache::version || header.sourceSize != sourceSize ||
+        this->file->getSize() != expectedSize ||
+        (header.sourceModificationTime != sourceModificationTime &&
+         header.sourceHash != MeshCache::hashFile(modelPath))) {
+
+        this->file.reset();
+        return false;
+    }
+
+    // Store the new modification time, so that the model doesn't need to be hashed on every start
+    if (header.sourceModificationTime != sourceModificationTime) {
+        header.sourceModificationTime = sourceModificationTime;
+        std::fstream cacheFile(cachePath, std::ios::in | std::ios::out | std::ios::binary);
+        cacheFile.write(reinterpret_cast<const char *>(&header), sizeof(Header));
+    }
+
+    // Arrays are stored in order of decreasing alignment, so that none of them is misaligned
+    const char *data = this->file->getData() + sizeof(Header);
+
+    this->positions = std::span(reinterpret_cast<const glm::vec4 *>(data), header.vertexCount);
+    data += this->positions.size_bytes();
+
+    this->normals = std::span(reinterpret_cast<const glm::vec4 *>(data), header.vertexCount);
+    data += this->normals.size_bytes();
+
+    this->textureCoordinates =
+        std::span(reinterpret_cast<const glm::vec2 *>(data), header.vertexCount);
+    data += this->textureCoordinates.size_bytes();
+
+    this->indices = std::span(reinterpret_cast<const uint32_t *>(data), header.indexCount);
+
+    const float *center = header.boundingSphereCenter;
+    this->boundingSphere = BoundingSphere(glm::vec4(center[0], center[1], center[2], center[3]),
+                                          header.boundingSphereRadius);
+    return true;
+}
+
+void MeshCache::build(const utils::WavefrontOBJ &object) {
+    std::tie(this->loadedPositions,
+             this->loadedTextureCoordinates,
+             this->loadedNormals,
+             this->loadedIndices) = object.getIndexedVertices();
+
+    utils::MeshOptimizer::optimize(this->loadedPositions,
+                                   this->loadedTextureCoordinates,
+                                   this->loadedNormals,
+                                   this->loadedIndices);
+
+    this->positions = this->loadedPositions;
+    this->textureCoordinates = this->loadedTextureCoordinates;
+    this->normals = this->loadedNormals;
+    this->indices = this->loadedIndices;
+    this->boundingSphere = BoundingSphere(this->positions);
+}
+
+void MeshCache::write(const std::string &cachePath,
+                      uint64_t sourceSize,
+                      int64_t sourceModificationTime,
+                      uint64_t sourceHash) const {
+
+    Header header;
+    std::memset(&header, 0, sizeof(Header));
+    std::memcpy(header.magic, MeshCache::magic, sizeof(MeshCache::magic));
+    header.version = MeshCache::version;
+    header.vertexCount = this->positions.size();
+    header.indexCount = this->indices.size();
+    header.sourceSize = sourceSize;
+    header.sourceModificationTime = sourceModificationTime;
+    header.sourceHash = sourceHash;
+
+    const glm::vec4 &center = this->boundingSphere.getCenter();
+    for (int i = 0; i < 4; ++i) {
+        header.boundingSphereCenter[i] = center[i];
+    }
+    header.boundingSphereRadius = this->boundingSphere.getRadius();
+
+    // Write to a temporary file first, so that an interrupted write can't leave a broken cache
+    const std::string temporaryPath = cachePath + ".tmp";
+    {
+        std::ofstream cacheFile;
+        cacheFile.exceptions(std::ofstream::failbit | std::ofstream::badbit);
+        cacheFile.open(temporaryPath, std::ios::out | std::ios::trunc | std::ios::binary);
+
+        cacheFile.write(reinterpret_cast<const char *>(&header), sizeof(Header));
+        cacheFile.write(reinterpret_cast<const char *>(this->positions.data()),
+                        this->positions.size_bytes());
+        cacheFile.write(reinterpret_cast<const char *>(this->normals.data()),
+                        this->normals.size_bytes());
+        cacheFile.write(reinterpret_cast<const char *>(this->textureCoordinates.data()),
+                        this->textureCoordinates.size_bytes());
+        cacheFile.write(reinterpret_cast<const char *>(this->indices.data()),
+                        this->indices.size_bytes());
+        cacheFile.close();
+    }
+
+    std::filesystem::rename(temporaryPath, cachePath);
+}
+
+uint64_t MeshCache::hashFile(const std::string &filename) {
+    const utils::MappedFile file(filename);
+    if (!file.isOpen()) {
+        throw std::ios_base::failure("Failed to open model file: " + filename);
+    }
+
+    // FNV-1a
+    uint64_t hash = 0xcbf29ce484222325;
+    const char *const data = file.getData();
+    for (size_t i = 0; i < file.getSize(); ++i) {
+        hash = (hash ^ static_cast<uint8_t>(data[i])) * 0x100000001b3;
+    }
+
+    return hash;
+}
+
+}
@@ -12,23 +12,46 @@
 /// See the License for the specific language governing permissions and
 /// limitations under the License.
 
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <glm/geometric.hpp>
+#include <glm/gtc/packing.hpp>
+#include <glm/gtx/transform.hpp>
+#include <glm/matrix.hpp>
+#include <glm/packing.hpp>
+#include <limits>
+
 #include "engine/render/Model.hpp"
 
-#include "engine/render/ShadedShaderProgram.hpp"
 #include "engine/render/SolidColorShaderProgram.hpp"
+#include "utils/MeshOptimizer.hpp"
 
 namespace engine::render {
 
-Model::Model(const utils::WavefrontOBJ &objectFile) : Model(objectFile.getIndexedVertices()) {}
+Model::Model(const utils::WavefrontOBJ &objectFile) : Model(MeshCache(objectFile)) {}
 
-Model::~Model() {
-    GLuint buffers[4] = { this->positionsVBO,
-                          this->textureCoordinatesVBO,
-                          this->normalsVBO,
-                          this->ibo };
+Model::Model(const MeshCache &mesh, VertexFormat _vertexFormat) :
+    arena(GeometryArena::get(_vertexFormat)),
+    vertexFormat(_vertexFormat),
+    positionDecodeMatrix(1.0f),
+    textureCoordinateDecode(1.0f, 1.0f, 0.0f, 0.0f),
+    quantizationError { 0.0f, 0.0f, 0.0f },
+    boundingSphere(mesh.getBoundingSphere()),
+    normalsPreview(mesh.getPositions(), mesh.getNormals(), mesh.getIndices()) {
+
+    // Upload interleaved vertex data and index data to the arena
+    if (this->vertexFormat == VertexFormat::Float32) {
+        this->initializeFloatVertices(mesh);
+    } else {
+        this->initializeQuantizedVertices(mesh);
+    }
+    this->initializeClusters(mesh);
+}
 
-    glDeleteBuffers(4, buffers);
-    glDeleteVertexArrays(1, &this->vao);
+Model::~Model() {
+    this->arena.free(this->allocation);
 }
 
 const BoundingSphere &Model::getBoundingSphere() const {
@@ -39,6 +62,34 @@ const NormalsPreview &Model::getNormalsPreview() const {
     return this->normalsPreview;
 }
 
+int Model::getTriangleCount() const {
+    return this->allocation.indexCount / 3;
+}
+
+VertexFormat Model::getVertexFormat() const {
+    return this->vertexFormat;
+}
+
+const Model::QuantizationError &Model::getQuantizationError() const {
+    return this->quantizationError;
+}
+
+const GeometryArena &Model::getArena() const {
+    return this->arena;
+}
+
+GLenum Model::getIndexType() const {
+    return this->allocation.indexType;
+}
+
+const glm::mat4 &Model::getPositionDecodeMatrix() const {
+    return this->positionDecodeMatrix;
+}
+
+const glm::vec4 &Model::getTextureCoordinateDecode() const {
+    return this->textureCoordinateDecode;
+}
+
 void Model::drawSolidColor(RenderPipelineManager &pipelineManager,
                            const glm::mat4 &fullMatrix,
                            const glm::vec4 &color,
@@ -46,77 +97,341 @@ void Model::drawSolidColor(RenderPipelineManager &pipelineManager,
 
     const SolidColorShaderProgram &shader = pipelineManager.getSolidColorShaderProgram();
     pipelineManager.setFillPolygons(fillPolygons);
-    shader.setFullMatrix(fullMatrix);
+    shader.setFullMatrix(fullMatrix * this->positionDecodeMatrix);
     shader.setColor(color);
 
-    glBindVertexArray(this->vao);
-    glDrawElements(GL_TRIANGLES, this->vertexCount, GL_UNSIGNED_INT, nullptr);
+    this->drawElements(pipelineManager, fullMatrix);
 }
 
-void Model::drawShaded(RenderPipelineManager &pipelineManager,
-                       const glm::mat4 &fullMatrix,
-                       const glm::mat4 &worldMatrix,
-                       const glm::mat4 &normalMatrix,
-                       const std::shared_ptr<Texture> texture,
-                       const scene::Material &material) const {
+void Model::getDrawCommands(const RenderPipelineManager &pipelineManager,
+                            const glm::mat4 &fullMatrix,
+                            GLuint firstInstance,
+                            GLuint instanceCount,
+                            std::vector<GeometryArena::DrawCommand> &commands) const {
 
-    const ShadedShaderProgram &shader = pipelineManager.getShadedShaderProgram();
-    pipelineManager.setFillPolygons(true);
-    shader.setFullMatrix(fullMatrix);
-    shader.setWorldMatrix(worldMatrix);
-    shader.setNormalMatrix(normalMatrix);
+    // Entities have already been culled as a whole
+    if (this->clusters.size() <= 1 || instanceCount != 1) {
+        commands.push_back({ static_cast<GLuint>(this->allocation.indexCount),
+                             instanceCount,
+                             this->allocation.firstIndex,
+                             this->allocation.baseVertex,
+                             firstInstance });
+        return;
+    }
 
-    if (texture) {
-        shader.setTexture(*texture, material);
-    } else {
-        shader.setMaterial(material);
+    // Frustum planes in model space (Gribb and Hartmann)
+    const glm::mat4 rows = glm::transpose(fullMatrix);
+    glm::vec4 frustumPlanes[6];
+    for (int i = 0; i < 3; ++i) {
+        frustumPlanes[2 * i + 0] = rows[3] + rows[i];
+        frustumPlanes[2 * i + 1] = rows[3] - rows[i];
     }
 
-    glBindVertexArray(this->vao);
-    glDrawElements(GL_TRIANGLES, this->vertexCount, GL_UNSIGNED_INT, nullptr);
+    for (glm::vec4 &plane : frustumPlanes) {
+        plane /= glm::length(glm::vec3(plane));
+    }
+
+    // The camera is the only point projected to w = 0 with x = y = 0
+    const glm::vec4 camera = glm::inverse(fullMatrix) * glm::vec4(0.0f, 0.0f, 1.0f, 0.0f);
+    const bool cullBackFaces = pipelineManager.isCullingBackFaces() && camera.w != 0.0f;
+    const glm::vec3 cameraPosition = cullBackFaces ? glm::vec3(camera) / camera.w : glm::vec3(0.0f);
+
+    // Merge visible clusters that are contiguous in the index buffer
+    const size_t firstCommand = commands.size();
+    uint32_t rangeEnd = 0;
+
+    for (const Cluster &cluster : this->clusters) {
+        if (!Model::isClusterVisible(cluster, frustumPlanes, cameraPosition, cullBackFaces)) {
+            continue;
+        }
+
+        if (commands.size() > firstCommand && rangeEnd == cluster.firstIndex) {
+            commands.back().count += cluster.indexCount;
+        } else {
+            commands.push_back({ cluster.indexCount,
+                                 1,
+                                 this->allocation.firstIndex + cluster.firstIndex,
+                                 this->allocation.baseVertex,
+                                 firstInstance });
+        }
+        rangeEnd = cluster.firstIndex + cluster.indexCount;
+    }
+}
+
+void Model::initializeFloatVertices(const MeshCache &mesh) {
+    const std::span<const glm::vec4> positions = mesh.getPositions();
+    const std::span<const glm::vec2> textureCoordinates = mesh.getTextureCoordinates();
+    const std::span<const glm::vec4> normals = mesh.getNormals();
+
+    std::vector<GeometryArena::FloatVertex> vertices(positions.size());
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        vertices[i].position = positions[i];
+        vertices[i].textureCoordinate = textureCoordinates[i];
+        vertices[i].normal = glm::vec3(normals[i]);
+    }
+
+    this->allocation = this->arena.allocate(vertices.data(), vertices.size(), mesh.getIndices());
 }
 
-Model::Model(const std::tuple<std::vector<glm::vec4>,
-                              std::vector<glm::vec2>,
-                              std::vector<glm::vec4>,
-                              std::vector<uint32_t>> &modelData) :
-    boundingSphere(std::get<0>(modelData)),
-    normalsPreview(std::get<0>(modelData), std::get<2>(modelData), std::get<3>(modelData)) {
+void Model::initializeQuantizedVertices(const MeshCache &mesh) {
+    std::vector<GeometryArena::QuantizedVertex> vertices(mesh.getPositions().size());
+    this->quantizePositions(mesh.getPositions(), vertices);
+    this->quantizeTextureCoordinates(mesh.getTextureCoordinates(), vertices);
+    this->quantizeNormals(mesh.getNormals(), vertices);
 
-    const auto &[positions, textureCoordinates, normals, indices] = modelData;
+    this->allocation = this->arena.allocate(vertices.data(), vertices.size(), mesh.getIndices());
+}
+
+void Model::initializeClusters(const MeshCache &mesh) {
+    const std::span<const glm::vec4> positions = mesh.getPositions();
+    const std::span<const uint32_t> indices = mesh.getIndices();
+
+    const auto getPosition = [positions](uint32_t index) {
+        const glm::vec4 &position = positions[index];
+        return position.w != 0.0f ? glm::vec3(position) / position.w : glm::vec3(position);
+    };
+
+    // MeshOptimizer groups triangles into compact clusters
+    const size_t indicesPerCluster = utils::MeshOptimizer::clusterSize * 3;
+    std::vector<glm::vec3> triangleNormals;
+    for (size_t first = 0; first < indices.size(); first += indicesPerCluster) {
+        const size_t count = std::min<size_t>(indicesPerCluster, indices.size() - first);
+        const std::span<const uint32_t> clusterIndices = indices.subspan(first, count);
+
+        Cluster cluster;
+        cluster.firstIndex = first;
+        cluster.indexCount = count;
+
+        // Bounding sphere, grown to contain vertices moved by quantization
+        cluster.center = glm::vec3(0.0f);
+        for (uint32_t index : clusterIndices) {
+            cluster.center += getPosition(index);
+        }
+        cluster.center /= static_cast<float>(count);
 
-    // Generate buffers
-    glGenVertexArrays(1, &this->vao);
+        cluster.radius = 0.0f;
+        for (uint32_t index : clusterIndices) {
+            cluster.radius =
+                std::max(cluster.radius, glm::distance(cluster.center, getPosition(index)));
+        }
+        cluster.radius += this->quantizationError.position;
 
-    GLuint buffers[4];
-    glGenBuffers(4, buffers);
-    this->positionsVBO = buffers[0];
-    this->textureCoordinatesVBO = buffers[1];
-    this->normalsVBO = buffers[2];
-    this->ibo = buffers[3];
+        // Normal cone around the average of the (non-degenerate) triangles' normals
+        triangleNormals.clear();
+        cluster.coneAxis = glm::vec3(0.0f);
+        for (size_t i = 0; i < count; i += 3) {
+            const glm::vec3 p0 = getPosition(clusterIndices[i + 0]);
+            const glm::vec3 p1 = getPosition(clusterIndices[i + 1]);
+            const glm::vec3 p2 = getPosition(clusterIndices[i + 2]);
+
+            const glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+            const float length = glm::length(normal);
+            if (length > 0.0f) {
+                triangleNormals.push_back(normal / length);
+                cluster.coneAxis += normal / length;
+            }
+        }
+
+        const float axisLength = glm::length(cluster.coneAxis);
+        cluster.coneCosine = -1.0f;
+        if (axisLength > 0.0f) {
+            cluster.coneAxis /= axisLength;
+            cluster.coneCosine = 1.0f;
+            for (const glm::vec3 &normal : triangleNormals) {
+                cluster.coneCosine =
+                    std::min(cluster.coneCosine, glm::dot(cluster.coneAxis, normal));
+            }
+        }
+        cluster.coneSine =
+            std::sqrt(std::max(1.0f - cluster.coneCosine * cluster.coneCosine, 0.0f));
+
+        this->clusters.push_back(cluster);
+    }
+}
 
-    // Upload position, texture coordinate, and normal data
-    glBindVertexArray(this->vao);
-    this->initializeBuffer(0, this->positionsVBO, positions);
-    this->initializeBuffer(1, this->textureCoordinatesVBO, textureCoordinates);
-    this->initializeBuffer(2, this->normalsVBO, normals);
+void Model::quantizePositions(std::span<const glm::vec4> positions,
+                              std::span<GeometryArena::QuantizedVertex> vertices) {
 
-    // Fill index data
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->ibo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER,
-                 indices.size() * sizeof(uint32_t),
-                 indices.data(),
-                 GL_STATIC_DRAW);
+    // Store positions relative to the bounding sphere, so that all coordinates are in [-1, 1]
+    const glm::vec3 center = glm::vec3(this->boundingSphere.getCenter());
+    const float radius =
+        this->boundingSphere.getRadius() > 0.0f ? this->boundingSphere.getRadius() : 1.0f;
+    this->positionDecodeMatrix = glm::translate(center) * glm::scale(glm::vec3(radius));
 
-    this->vertexCount = indices.size();
+    for (size_t i = 0; i < positions.size(); ++i) {
+        const glm::vec4 &homogeneous = positions[i];
+        const glm::vec3 position = homogeneous.w != 0.0f
+            ? glm::vec3(homogeneous) / homogeneous.w
+            : glm::vec3(homogeneous);
+        const glm::vec4 relative = glm::vec4((position - center) / radius, 1.0f);
+
+        glm::vec4 decoded;
+        if (this->vertexFormat == VertexFormat::Float16) {
+            vertices[i].position = glm::packHalf4x16(relative);
+            decoded = glm::unpackHalf4x16(vertices[i].position);
+        } else {
+            vertices[i].position = glm::packSnorm4x16(relative);
+            decoded = glm::unpackSnorm4x16(vertices[i].position);
+        }
+
+        this->quantizationError.position =
+            std::max(this->quantizationError.position,
+                     glm::distance(center + glm::vec3(decoded) * radius, position));
+    }
+}
+
+void Model::quantizeTextureCoordinates(std::span<const glm::vec2> textureCoordinates,
+                                       std::span<GeometryArena::QuantizedVertex> vertices) {
+
+    // Normalized coordinates are stored relative to their range, as they may be outside [0, 1]
+    glm::vec2 minimum = glm::vec2(0.0f), scale = glm::vec2(1.0f);
+    if (this->vertexFormat == VertexFormat::Normalized16 && !textureCoordinates.empty()) {
+        minimum = textureCoordinates[0];
+        glm::vec2 maximum = textureCoordinates[0];
+        for (const glm::vec2 &textureCoordinate : textureCoordinates) {
+            minimum = glm::vec2(std::min(minimum.x, textureCoordinate.x),
+                                std::min(minimum.y, textureCoordinate.y));
+            maximum = glm::vec2(std::max(maximum.x, textureCoordinate.x),
+                                std::max(maximum.y, textureCoordinate.y));
+        }
+
+        scale = glm::vec2(maximum.x > minimum.x ? maximum.x - minimum.x : 1.0f,
+                          maximum.y > minimum.y ? maximum.y - minimum.y : 1.0f);
+    }
+    this->textureCoordinateDecode = glm::vec4(scale.x, scale.y, minimum.x, minimum.y);
+
+    for (size_t i = 0; i < textureCoordinates.size(); ++i) {
+        const glm::vec2 &textureCoordinate = textureCoordinates[i];
+
+        glm::vec2 decoded;
+        if (this->vertexFormat == VertexFormat::Float16) {
+            vertices[i].textureCoordinate = glm::packHalf2x16(textureCoordinate);
+            decoded = glm::unpackHalf2x16(vertices[i].textureCoordinate);
+        } else {
+            vertices[i].textureCoordinate =
+                glm::packUnorm2x16((textureCoordinate - minimum) / scale);
+            decoded = glm::unpackUnorm2x16(vertices[i].textureCoordinate) * scale + minimum;
+        }
+
+        this->quantizationError.textureCoordinate =
+            std::max({ this->quantizationError.textureCoordinate,
+                       std::abs(decoded.x - textureCoordinate.x),
+                       std::abs(decoded.y - textureCoordinate.y) });
+    }
+}
+
+void Model::quantizeNormals(std::span<const glm::vec4> normals,
+                            std::span<GeometryArena::QuantizedVertex> vertices) {
+
+    for (size_t i = 0; i < normals.size(); ++i) {
+        const glm::vec3 normal = glm::vec3(normals[i]);
+        if (glm::length(normal) == 0.0f) {
+            continue;
+        }
+
+        // Rounding to the nearest value isn't always the most accurate, so try all neighbors
+        const glm::vec2 octahedral = Model::encodeOctahedral(normal) * 32767.0f;
+        float bestError = std::numeric_limits<float>::infinity();
+
+        for (int j = 0; j < 4; ++j) {
+            const glm::vec2 candidate =
+                glm::vec2(j & 1 ? std::ceil(octahedral.x) : std::floor(octahedral.x),
+                          j & 2 ? std::ceil(octahedral.y) : std::floor(octahedral.y));
+            const uint32_t packed = glm::packSnorm2x16(candidate / 32767.0f);
+
+            const glm::vec3 decoded = Model::decodeOctahedral(glm::unpackSnorm2x16(packed));
+            const float error = std::atan2(glm::length(glm::cross(decoded, normal)),
+                                           glm::dot(decoded, normal));
+
+            if (error < bestError) {
+                bestError = error;
+                vertices[i].normal = packed;
+            }
+        }
+
+        this->quantizationError.normal = std::max(this->quantizationError.normal, bestError);
+    }
+}
+
+void Model::drawElements(RenderPipelineManager &pipelineManager,
+                         const glm::mat4 &fullMatrix) const {
+
+    std::vector<GeometryArena::DrawCommand> commands;
+    this->getDrawCommands(pipelineManager, fullMatrix, 0, 1, commands);
+
+    const size_t indexSize = GeometryArena::getIndexSize(this->allocation.indexType);
+    std::vector<GLsizei> counts;
+    std::vector<const void *> offsets;
+    for (const GeometryArena::DrawCommand &command : commands) {
+        counts.push_back(command.count);
+        offsets.push_back(reinterpret_cast<const void *>(command.firstIndex * indexSize));
+    }
+
+    if (!counts.empty()) {
+        const std::vector<GLint> baseVertices(counts.size(), this->allocation.baseVertex);
+
+        pipelineManager.bindVertexArray(this->arena.getVertexArray());
+        glMultiDrawElementsBaseVertex(GL_TRIANGLES,
+                                      counts.data(),
+                                      this->allocation.indexType,
+                                      offsets.data(),
+                                      counts.size(),
+                                      baseVertices.data());
+    }
+}
+
+bool Model::isClusterVisible(const Cluster &cluster,
+                             std::span<const glm::vec4, 6> frustumPlanes,
+                             const glm::vec3 &cameraPosition,
+                             bool cullBackFaces) {
+
+    for (const glm::vec4 &plane : frustumPlanes) {
+        if (glm::dot(glm::vec3(plane), cluster.center) + plane.w < -cluster.radius) {
+            return false;
+        }
+    }
+
+    if (!cullBackFaces || cluster.coneCosine <= 0.0f) {
+        return true;
+    }
+
+    const glm::vec3 view = cluster.center - cameraPosition;
+    const float distance = glm::length(view);
+    if (distance <= cluster.radius) {
+        return true;
+    }
+
+    // Every triangle faces away if, for all points in the sphere, the angle between the direction
+    // from the camera and the cone's axis is under 90º minus the cone's half-angle
+    const float sphereSine = cluster.radius / distance;
+    const float sphereCosine = std::sqrt(1.0f - sphereSine * sphereSine);
+    const float angleCosine = cluster.coneCosine * sphereCosine - cluster.coneSine * sphereSine;
+    const float angleSine = cluster.coneSine * sphereCosine + cluster.coneCosine * sphereSine;
+
+    return angleCosine <= 0.0f || glm::dot(view, cluster.coneAxis) <= angleSine * distance;
+}
+
+glm::vec2 Model::encodeOctahedral(const glm::vec3 &normal) {
+    // Project onto the octahedron |x| + |y| + |z| = 1 and unfold its lower half
+    const glm::vec3 projected =
+        normal / (std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z));
+
+    if (projected.z >= 0.0f) {
+        return glm::vec2(projected.x, projected.y);
+    } else {
+        return glm::vec2((1.0f - std::abs(projected.y)) * (projected.x >= 0.0f ? 1.0f : -1.0f),
+                         (1.0f - std::abs(projected.x)) * (projected.y >= 0.0f ? 1.0f : -1.0f));
+    }
 }
 
-template<class V>
-void Model::initializeBuffer(GLuint attribute, GLuint vbo, const std::vector<V> &data) {
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glBufferData(GL_ARRAY_BUFFER, data.size() * sizeof(V), data.data(), GL_STATIC_DRAW);
-    glVertexAttribPointer(attribute, V::length(), GL_FLOAT, false, sizeof(V), nullptr);
-    glEnableVertexAttribArray(attribute);
+glm::vec3 Model::decodeOctahedral(const glm::vec2 &encoded) {
+    // Same as in ShadedShaderProgram's vertex shader
+    glm::vec3 normal =
+        glm::vec3(encoded.x, encoded.y, 1.0f - std::abs(encoded.x) - std::abs(encoded.y));
+    const float fold = std::max(-normal.z, 0.0f);
+    normal.x += normal.x >= 0.0f ? -fold : fold;
+    normal.y += normal.y >= 0.0f ? -fold : fold;
+    return glm::normalize(normal);
 }
 
 }
@@ -12,15 +12,17 @@
 /// See the License for the specific language governing permissions and
 /// limitations under the License.
 
+#include <vector>
+
 #include "engine/render/NormalsPreview.hpp"
 
 #include "engine/render/SolidColorShaderProgram.hpp"
 
 namespace engine::render {
 
-NormalsPreview::NormalsPreview(const std::vector<glm::vec4> &positions,
-                               const std::vector<glm::vec4> &normals,
-                               const std::vector<uint32_t> &indices) {
+NormalsPreview::NormalsPreview(std::span<const glm::vec4> positions,
+                               std::span<const glm::vec4> normals,
+                               std::span<const uint32_t> indices) {
 
     // Create vertex data
     std::vector<glm::vec4> points;
@@ -61,7 +63,7 @@ void NormalsPreview::draw(RenderPipelineManager &pipelineManager,
     shader.setFullMatrix(fullMatrix);
     shader.setColor(color);
 
-    glBindVertexArray(this->vao);
+    pipelineManager.bindVertexArray(this->vao);
     glDrawArrays(GL_LINES, 0, this->vertexCount);
 }
 
@@ -0,0 +1,31 @@
+/// Copyright 2025 Ana Oliveira, Humberto Gomes, Mariana Rocha, Sara Lopes
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+
+#include "engine/render/OccluderMesh.hpp"
+
+namespace engine::render {
+
+OccluderMesh::OccluderMesh(const MeshCache &mesh) :
+    positions(mesh.getPositions().begin(), mesh.getPositions().end()),
+    indices(mesh.getIndices().begin(), mesh.getIndices().end()) {}
+
+std::span<const glm::vec3> OccluderMesh::getPositions() const {
+    return this->positions;
+}
+
+std::span<const uint32_t> OccluderMesh::getIndices() const {
+    return this->indices;
+}
+
+}
@@ -0,0 +1,300 @@
+/// Copyright 2025 Ana Oliveira, Humberto Gomes, Mariana Rocha, Sara Lopes
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+
+#include <algorithm>
+#include <cmath>
+
+#ifdef __x86_64__
+#include <immintrin.h>
+#endif
+
+#include "engine/render/OcclusionCuller.hpp"
+
+namespace engine::render {
+
+OcclusionCuller::OcclusionCuller(utils::JobSystem &_jobSystem) :
+    depthBuffer(tileRows * tileColumns * tileSize, 0.0f),
+    farthestDepths(tileRows * tileColumns, 0.0f),
+    viewMatrix(1.0f),
+    projectionMatrix(1.0f),
+    enabled(false),
+    avx2(false),
+    occludedEntities(0),
+    jobSystem(_jobSystem) {
+
+#ifdef __x86_64__
+    this->avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+}
+
+void OcclusionCuller::beginFrame(const glm::mat4 &_viewMatrix,
+                                 const glm::mat4 &_projectionMatrix,
+                                 bool enable) {
+
+    this->viewMatrix = _viewMatrix;
+    this->projectionMatrix = _projectionMatrix;
+    this->enabled = enable;
+    this->occludedEntities = 0;
+    this->triangles.clear();
+}
+
+void OcclusionCuller::addOccluder(const OccluderMesh &mesh, const glm::mat4 &fullMatrix) {
+    if (!this->enabled) {
+        return;
+    }
+
+    // Vertices are shared between triangles, so they're only transformed once
+    this->clipPositions.clear();
+    for (const glm::vec3 &position : mesh.getPositions()) {
+        this->clipPositions.push_back(fullMatrix * glm::vec4(position, 1.0f));
+    }
+
+    const std::span<const uint32_t> indices = mesh.getIndices();
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        const glm::vec4 clip[3] = { this->clipPositions[indices[i]],
+                                    this->clipPositions[indices[i + 1]],
+                                    this->clipPositions[indices[i + 2]] };
+
+        // Triangles crossing the near plane are skipped rather than clipped. That only makes
+        // occlusion less effective.
+        if (clip[0].z < -clip[0].w || clip[1].z < -clip[1].w || clip[2].z < -clip[2].w) {
+            continue;
+        }
+
+        float x[3], y[3], inverseW[3];
+        for (int j = 0; j < 3; ++j) {
+            inverseW[j] = 1.0f / clip[j].w;
+            x[j] = (clip[j].x * inverseW[j] * 0.5f + 0.5f) * OcclusionCuller::width;
+            y[j] = (clip[j].y * inverseW[j] * 0.5f + 0.5f) * OcclusionCuller::height;
+        }
+
+        // Back-facing and degenerate triangles can't hide anything that front-facing ones don't
+        const float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+        if (!(area > 0.0f)) {
+            continue;
+        }
+
+        Triangle triangle;
+        triangle.minX = std::max(static_cast<int>(std::floor(std::min({ x[0], x[1], x[2] }))), 0);
+        triangle.minY = std::max(static_cast<int>(std::floor(std::min({ y[0], y[1], y[2] }))), 0);
+        triangle.maxX = std::min(static_cast<int>(std::floor(std::max({ x[0], x[1], x[2] }))),
+                                 OcclusionCuller::width - 1);
+        triangle.maxY = std::min(static_cast<int>(std::floor(std::max({ y[0], y[1], y[2] }))),
+                                 OcclusionCuller::height - 1);
+        if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY) {
+            continue;
+        }
+
+        // Edge j goes from vertex j to the next one, and is opposite to the remaining vertex
+        for (int j = 0; j < 3; ++j) {
+            const int next = (j + 1) % 3;
+            triangle.edges[j][0] = y[j] - y[next];
+            triangle.edges[j][1] = x[next] - x[j];
+            triangle.edges[j][2] = -(triangle.edges[j][0] * x[j] + triangle.edges[j][1] * y[j]);
+        }
+
+        // Barycentric interpolation of 1 / w, where each vertex is weighted by its opposite edge
+        for (int j = 0; j < 3; ++j) {
+            triangle.depth[j] = (triangle.edges[1][j] * inverseW[0] +
+                                 triangle.edges[2][j] * inverseW[1] +
+                                 triangle.edges[0][j] * inverseW[2]) /
+                area;
+        }
+
+        this->triangles.push_back(triangle);
+    }
+}
+
+void OcclusionCuller::rasterize() {
+    if (!this->enabled || this->triangles.empty()) {
+        return;
+    }
+
+    this->jobSystem.parallelFor(OcclusionCuller::tileRows,
+                                OcclusionCuller::rowsPerJob,
+                                [this](uint32_t firstRow, uint32_t lastRow) {
+                                    this->rasterizeRows(firstRow, lastRow);
+                                });
+}
+
+bool OcclusionCuller::isOccluded(const BoundingSphere &sphere) const {
+    if (!this->enabled || this->triangles.empty()) {
+        return false;
+    }
+
+    const glm::vec4 center = this->viewMatrix * sphere.getCenter();
+    const float radius = sphere.getRadius();
+    const float nearest = -center.z - radius, farthest = -center.z + radius;
+    if (nearest <= 0.0f) {
+        return false;
+    }
+
+    // Conservative bounds of the sphere on the screen. Each side of its bounding box projects
+    // farthest from the center of the screen at either its nearest or its farthest depth.
+    const float left = center.x - radius, right = center.x + radius;
+    const float bottom = center.y - radius, top = center.y + radius;
+    const float ndcLeft = this->projectionMatrix[0][0] * left / (left < 0.0f ? nearest : farthest);
+    const float ndcRight =
+        this->projectionMatrix[0][0] * right / (right > 0.0f ? nearest : farthest);
+    const float ndcBottom =
+        this->projectionMatrix[1][1] * bottom / (bottom < 0.0f ? nearest : farthest);
+    const float ndcTop = this->projectionMatrix[1][1] * top / (top > 0.0f ? nearest : farthest);
+
+    const int minX = std::max(
+        static_cast<int>(std::floor((ndcLeft * 0.5f + 0.5f) * OcclusionCuller::width)), 0);
+    const int maxX = std::min(
+        static_cast<int>(std::floor((ndcRight * 0.5f + 0.5f) * OcclusionCuller::width)),
+        OcclusionCuller::width - 1);
+    const int minY = std::max(
+        static_cast<int>(std::floor((ndcBottom * 0.5f + 0.5f) * OcclusionCuller::height)), 0);
+    const int maxY = std::min(
+        static_cast<int>(std::floor((ndcTop * 0.5f + 0.5f) * OcclusionCuller::height)),
+        OcclusionCuller::height - 1);
+    if (minX > maxX || minY > maxY) {
+        return false;
+    }
+
+    // Occluded only if every tile it covers is entirely in front of it
+    const float sphereDepth = 1.0f / nearest;
+    for (int row = minY / OcclusionCuller::tileHeight; row <= maxY / OcclusionCuller::tileHeight;
+         ++row) {
+
+        for (int column = minX / OcclusionCuller::tileWidth;
+             column <= maxX / OcclusionCuller::tileWidth;
+             ++column) {
+
+            if (this->farthestDepths[row * OcclusionCuller::tileColumns + column] <= sphereDepth) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+void OcclusionCuller::countOccluded(int entityCount) {
+    this->occludedEntities += entityCount;
+}
+
+int OcclusionCuller::getOccludedEntities() const {
+    return this->occludedEntities;
+}
+
+void OcclusionCuller::rasterizeRows(int firstRow, int lastRow) {
+    // Jobs get whole rows of tiles, so that no two threads ever write to the same tile
+    const int tilesPerRow = OcclusionCuller::tileColumns * OcclusionCuller::tileSize;
+    std::fill(this->depthBuffer.begin() + firstRow * tilesPerRow,
+              this->depthBuffer.begin() + lastRow * tilesPerRow,
+              0.0f);
+
+    for (const Triangle &triangle : this->triangles) {
+        const int rowBegin = std::max(triangle.minY / OcclusionCuller::tileHeight, firstRow);
+        const int rowEnd = std::min(triangle.maxY / OcclusionCuller::tileHeight + 1, lastRow);
+        const int columnBegin = triangle.minX / OcclusionCuller::tileWidth;
+        const int columnEnd = triangle.maxX / OcclusionCuller::tileWidth + 1;
+
+        for (int row = rowBegin; row < rowEnd; ++row) {
+            for (int column = columnBegin; column < columnEnd; ++column) {
+                float *tile = &this->depthBuffer[(row * OcclusionCuller::tileColumns + column) *
+                                                 OcclusionCuller::tileSize];
+                const int x = column * OcclusionCuller::tileWidth;
+                const int y = row * OcclusionCuller::tileHeight;
+
+                if (this->avx2) {
+                    this->rasterizeTileAVX2(triangle, tile, x, y);
+                } else {
+                    this->rasterizeTile(triangle, tile, x, y);
+                }
+            }
+        }
+    }
+
+    // Entities are only tested against the farthest depth of each tile
+    for (int i = firstRow * OcclusionCuller::tileColumns;
+         i < lastRow * OcclusionCuller::tileColumns;
+         ++i) {
+
+        const float *tile = &this->depthBuffer[i * OcclusionCuller::tileSize];
+        this->farthestDepths[i] = *std::min_element(tile, tile + OcclusionCuller::tileSize);
+    }
+}
+
+void OcclusionCuller::rasterizeTile(const Triangle &triangle, float *tile, int x, int y) const {
+    for (int row = 0; row < OcclusionCuller::tileHeight; ++row) {
+        const float pixelY = y + row + 0.5f;
+
+        for (int column = 0; column < OcclusionCuller::tileWidth; ++column) {
+            const float pixelX = x + column + 0.5f;
+
+            bool inside = true;
+            for (int i = 0; i < 3; ++i) {
+                const float *edge = triangle.edges[i];
+                inside = inside && edge[0] * pixelX + edge[1] * pixelY + edge[2] >= 0.0f;
+            }
+
+            if (inside) {
+                const float *plane = triangle.depth;
+                float &pixel = tile[row * OcclusionCuller::tileWidth + column];
+                pixel = std::max(pixel, plane[0] * pixelX + plane[1] * pixelY + plane[2]);
+            }
+        }
+    }
+}
+
+#ifdef __x86_64__
+__attribute__((target("avx2,fma"))) void OcclusionCuller::rasterizeTileAVX2(
+    const Triangle &triangle,
+    float *tile,
+    int x,
+    int y) const {
+
+    // A whole row of the tile is rasterized at once
+    const __m256 pixelX = _mm256_add_ps(
+        _mm256_set1_ps(static_cast<float>(x)),
+        _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f));
+    const __m256 zero = _mm256_setzero_ps();
+
+    for (int row = 0; row < OcclusionCuller::tileHeight; ++row) {
+        const float pixelY = y + row + 0.5f;
+
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (int i = 0; i < 3; ++i) {
+            const float *edge = triangle.edges[i];
+            const __m256 value = _mm256_fmadd_ps(_mm256_set1_ps(edge[0]),
+                                                 pixelX,
+                                                 _mm256_set1_ps(edge[1] * pixelY + edge[2]));
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(value, zero, _CMP_GE_OQ));
+        }
+
+        const float *plane = triangle.depth;
+        const __m256 depth = _mm256_fmadd_ps(_mm256_set1_ps(plane[0]),
+                                             pixelX,
+                                             _mm256_set1_ps(plane[1] * pixelY + plane[2]));
+
+        float *pixels = tile + row * OcclusionCuller::tileWidth;
+        const __m256 previous = _mm256_loadu_ps(pixels);
+        _mm256_storeu_ps(pixels,
+                         _mm256_blendv_ps(previous, _mm256_max_ps(previous, depth), inside));
+    }
+}
+#else
+void OcclusionCuller::rasterizeTileAVX2(const Triangle &triangle,
+                                        float *tile,
+                                        int x,
+                                        int y) const {
+    this->rasterizeTile(triangle, tile, x, y);
+}
+#endif
+
+}
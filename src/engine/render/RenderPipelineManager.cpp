@@ -12,19 +12,158 @@
 /// See the License for the specific language governing permissions and
 /// limitations under the License.
 
+#include <algorithm>
+#include <cmath>
 #include <glad/glad.h>
+#include <stdexcept>
 
 #include "engine/render/RenderPipelineManager.hpp"
+#include "engine/scene/light/DirectionalLight.hpp"
+#include "engine/scene/light/PointLight.hpp"
+#include "engine/scene/light/Spotlight.hpp"
 
 namespace engine::render {
 
-RenderPipelineManager::RenderPipelineManager(int pointLights,
-                                             int directionalLights,
-                                             int spotlights) :
-    shadedShaderProgram(pointLights, directionalLights, spotlights),
+RenderPipelineManager::RenderPipelineManager(const std::vector<scene::Material> &materials) :
+    currentFrame { glm::mat4(0.0f), glm::vec3(0.0f), 0.0f, 0.0f, { 0.0f, 0.0f, 0.0f } },
+    lightGrid(),
+    clustersOutdated(true),
+    shadedShaderProgram(),
+    depthShaderProgram(),
     solidColorShaderProgram(),
     currentProgram(nullptr),
-    currentfillPolygons(true) {}
+    currentVertexArray(0),
+    currentTexture(nullptr),
+    currentfillPolygons(true),
+    currentBackFaceCulling(false) {
+
+    GLuint buffers[3];
+    glGenBuffers(3, buffers);
+    this->frameUniformBuffer = buffers[0];
+    this->lightStorageBuffer = buffers[1];
+    this->materialStorageBuffer = buffers[2];
+
+    // The camera matrix is never zero, so the first camera is always uploaded
+    glBindBuffer(GL_UNIFORM_BUFFER, this->frameUniformBuffer);
+    glBufferStorage(GL_UNIFORM_BUFFER,
+                    sizeof(FrameUniforms),
+                    &this->currentFrame,
+                    GL_DYNAMIC_STORAGE_BIT);
+    glBindBufferBase(GL_UNIFORM_BUFFER, 0, this->frameUniformBuffer);
+
+    // Materials never change after the scene is loaded
+    std::vector<MaterialData> table(std::max<size_t>(materials.size(), 1));
+    for (size_t i = 0; i < materials.size(); ++i) {
+        table[i].diffuse = materials[i].getDiffuse();
+        table[i].shininess = materials[i].getShininess();
+        table[i].ambient = materials[i].getAmbient();
+        table[i].specular = materials[i].getSpecular();
+        table[i].emissive = materials[i].getEmissive();
+    }
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->materialStorageBuffer);
+    glBufferStorage(GL_SHADER_STORAGE_BUFFER, table.size() * sizeof(MaterialData), table.data(), 0);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, this->materialStorageBuffer);
+
+    // All programs may have been compiled in parallel. Report their errors while loading.
+    this->shadedShaderProgram.waitForLinking();
+    this->depthShaderProgram.waitForLinking();
+    this->solidColorShaderProgram.waitForLinking();
+}
+
+RenderPipelineManager::~RenderPipelineManager() {
+    GLuint buffers[3] = {
+        this->frameUniformBuffer,
+        this->lightStorageBuffer,
+        this->materialStorageBuffer,
+    };
+    glDeleteBuffers(3, buffers);
+}
+
+void RenderPipelineManager::setCamera(const glm::mat4 &viewMatrix,
+                                      const glm::mat4 &projectionMatrix,
+                                      const glm::vec3 &cameraPosition,
+                                      float near,
+                                      float far) {
+
+    const glm::mat4 cameraMatrix = projectionMatrix * viewMatrix;
+    const glm::vec2 sliceTransform = LightGrid::getSliceTransform(near, far);
+
+    if (this->currentFrame.cameraMatrix != cameraMatrix ||
+        this->currentFrame.cameraPosition != cameraPosition ||
+        this->currentFrame.clusterScale != sliceTransform.x ||
+        this->currentFrame.clusterBias != sliceTransform.y) {
+
+        this->currentFrame.cameraMatrix = cameraMatrix;
+        this->currentFrame.cameraPosition = cameraPosition;
+        this->currentFrame.clusterScale = sliceTransform.x;
+        this->currentFrame.clusterBias = sliceTransform.y;
+
+        glBindBuffer(GL_UNIFORM_BUFFER, this->frameUniformBuffer);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameUniforms), &this->currentFrame);
+        this->clustersOutdated = true;
+    }
+
+    if (this->clustersOutdated) {
+        this->lightGrid.update(viewMatrix, projectionMatrix, near, far);
+        this->clustersOutdated = false;
+    }
+}
+
+void RenderPipelineManager::setLights(
+    const std::vector<std::unique_ptr<scene::light::Light>> &lights) {
+
+    // Directional lights come first, as they aren't clustered
+    std::vector<LightData> table;
+    for (const std::unique_ptr<scene::light::Light> &light : lights) {
+        if (light->getType() == scene::light::Light::Type::Directional) {
+            const auto &directionalLight =
+                static_cast<const scene::light::DirectionalLight &>(*light);
+            table.push_back({ glm::vec3(0.0f), 0.0f, directionalLight.getDirection(), 0.0f });
+        }
+    }
+    const GLuint directionalLightCount = table.size();
+
+    this->lightGrid.clearLights();
+    for (const std::unique_ptr<scene::light::Light> &light : lights) {
+        switch (light->getType()) {
+            case scene::light::Light::Type::Point: {
+                const auto &pointLight = static_cast<const scene::light::PointLight &>(*light);
+                table.push_back(
+                    { pointLight.getPosition(), -1.0f, glm::vec3(0.0f), pointLight.getRange() });
+                break;
+            }
+            case scene::light::Light::Type::Spot: {
+                const auto &spotlight = static_cast<const scene::light::Spotlight &>(*light);
+                table.push_back({ spotlight.getPosition(),
+                                  std::cos(spotlight.getCutoff()),
+                                  spotlight.getDirection(),
+                                  spotlight.getRange() });
+                break;
+            }
+            case scene::light::Light::Type::Directional:
+                continue;
+        }
+
+        this->lightGrid.addLight(table.size() - 1, table.back().position, table.back().range);
+    }
+
+    // The light count is followed by the table, aligned like a vec3 (std430)
+    const size_t headerSize = sizeof(glm::vec4);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->lightStorageBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER,
+                 headerSize + table.size() * sizeof(LightData),
+                 nullptr,
+                 GL_STATIC_DRAW);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(GLuint), &directionalLightCount);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER,
+                    headerSize,
+                    table.size() * sizeof(LightData),
+                    table.data());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, this->lightStorageBuffer);
+
+    this->clustersOutdated = true;
+}
 
 void RenderPipelineManager::setFillPolygons(bool fillPolygons) {
     if (this->currentfillPolygons != fillPolygons) {
@@ -33,6 +172,36 @@ void RenderPipelineManager::setFillPolygons(bool fillPolygons) {
     }
 }
 
+void RenderPipelineManager::setBackFaceCulling(bool backFaceCulling) {
+    if (this->currentBackFaceCulling != backFaceCulling) {
+        if (backFaceCulling) {
+            glEnable(GL_CULL_FACE);
+            glCullFace(GL_BACK);
+        } else {
+            glDisable(GL_CULL_FACE);
+        }
+        this->currentBackFaceCulling = backFaceCulling;
+    }
+}
+
+bool RenderPipelineManager::isCullingBackFaces() const {
+    return this->currentBackFaceCulling;
+}
+
+void RenderPipelineManager::bindVertexArray(GLuint vao) {
+    if (this->currentVertexArray != vao) {
+        glBindVertexArray(vao);
+        this->currentVertexArray = vao;
+    }
+}
+
+void RenderPipelineManager::useTexture(const Texture &texture) {
+    if (this->currentTexture != &texture) {
+        texture.use();
+        this->currentTexture = &texture;
+    }
+}
+
 const SolidColorShaderProgram &RenderPipelineManager::getSolidColorShaderProgram() {
     this->useProgram(&this->solidColorShaderProgram);
     return this->solidColorShaderProgram;
@@ -43,6 +212,11 @@ const ShadedShaderProgram &RenderPipelineManager::getShadedShaderProgram() {
     return this->shadedShaderProgram;
 }
 
+const DepthShaderProgram &RenderPipelineManager::getDepthShaderProgram() {
+    this->useProgram(&this->depthShaderProgram);
+    return this->depthShaderProgram;
+}
+
 void RenderPipelineManager::useProgram(ShaderProgram *program) {
     if (this->currentProgram != program) {
         program->use();
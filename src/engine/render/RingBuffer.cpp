@@ -0,0 +1,107 @@
+/// Copyright 2025 Ana Oliveira, Humberto Gomes, Mariana Rocha, Sara Lopes
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+
+#include <algorithm>
+
+#include "engine/render/RingBuffer.hpp"
+
+namespace engine::render {
+
+RingBuffer::RingBuffer() : currentSegment(0), used(0) {
+    GLint storageAlignment;
+    glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &storageAlignment);
+    this->alignment = std::max<GLint>(storageAlignment, 4);
+
+    this->create(RingBuffer::initialSegmentSize);
+}
+
+RingBuffer::~RingBuffer() {
+    this->destroy();
+}
+
+void RingBuffer::beginFrame(size_t size) {
+    this->currentSegment = (this->currentSegment + 1) % RingBuffer::segmentCount;
+    this->used = 0;
+
+    if (size > this->segmentSize) {
+        // Deleting a buffer the GPU is still reading from is safe, OpenGL keeps it until it's done
+        this->destroy();
+        this->create(std::max(size, 2 * this->segmentSize));
+    } else {
+        RingBuffer::wait(this->fences[this->currentSegment]);
+    }
+}
+
+void RingBuffer::endFrame() {
+    this->fences[this->currentSegment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+size_t RingBuffer::allocate(size_t size, void *&data) {
+    const size_t offset = this->currentSegment * this->segmentSize + this->used;
+    data = this->mapping + offset;
+    this->used += this->getAlignedSize(size);
+    return offset;
+}
+
+GLuint RingBuffer::getBuffer() const {
+    return this->buffer;
+}
+
+size_t RingBuffer::getAlignedSize(size_t size) const {
+    return (size + this->alignment - 1) / this->alignment * this->alignment;
+}
+
+void RingBuffer::create(size_t _segmentSize) {
+    // Segments start aligned, as long as their size is aligned
+    this->segmentSize = this->getAlignedSize(_segmentSize);
+    const size_t size = RingBuffer::segmentCount * this->segmentSize;
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+    glGenBuffers(1, &this->buffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, this->buffer);
+    glBufferStorage(GL_COPY_WRITE_BUFFER, size, nullptr, flags);
+    this->mapping = static_cast<char *>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, size, flags));
+
+    std::fill_n(this->fences, RingBuffer::segmentCount, nullptr);
+}
+
+void RingBuffer::destroy() {
+    for (GLsync &fence : this->fences) {
+        if (fence) {
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+    }
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, this->buffer);
+    glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+    glDeleteBuffers(1, &this->buffer);
+}
+
+void RingBuffer::wait(GLsync &fence) {
+    if (!fence) {
+        return;
+    }
+
+    // Commands only need to be flushed once for the fence to be eventually signaled
+    GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+    while (glClientWaitSync(fence, flags, 1000000) == GL_TIMEOUT_EXPIRED) {
+        flags = 0;
+    }
+
+    glDeleteSync(fence);
+    fence = nullptr;
+}
+
+}
@@ -12,174 +12,112 @@
 /// See the License for the specific language governing permissions and
 /// limitations under the License.
 
-#include <cmath>
 #include <glad/glad.h>
-#include <glm/gtc/type_ptr.hpp>
 #include <regex>
 #include <sstream>
-#include <stdexcept>
 
+#include "engine/render/LightGrid.hpp"
 #include "engine/render/ShadedShaderProgram.hpp"
-#include "engine/scene/light/DirectionalLight.hpp"
-#include "engine/scene/light/PointLight.hpp"
-#include "engine/scene/light/Spotlight.hpp"
 
 namespace engine::render {
 
-ShadedShaderProgram::ShadedShaderProgram(int _pointLights,
-                                         int _directionalLights,
-                                         int _spotlights) :
-    ShaderProgram(ShadedShaderProgram::vertexShaderSource,
-                  ShadedShaderProgram::initializeFragmentShader(_pointLights,
-                                                                _directionalLights,
-                                                                _spotlights)),
-    pointLights(_pointLights),
-    directionalLights(_directionalLights),
-    spotlights(_spotlights),
-    fullMatrixUniformLocation(this->getUniformLocation("uniFullMatrix")),
-    worldMatrixUniformLocation(this->getUniformLocation("uniWorldMatrix")),
-    normalMatrixUniformLocation(this->getUniformLocation("uniNormalMatrix")),
-    cameraPositionUniformLocation(this->getUniformLocation("uniCameraPosition")),
-    texturedUniformLocation(this->getUniformLocation("uniTextured")),
-    diffuseUniformLocation(this->getUniformLocation("uniDiffuse")),
-    ambientUniformLocation(this->getUniformLocation("uniAmbient")),
-    specularUniformLocation(this->getUniformLocation("uniSpecular")),
-    emissiveUniformLocation(this->getUniformLocation("uniEmissive")),
-    shininessUniformLocation(this->getUniformLocation("uniShininess")),
-    pointPositionsUniformLocation(this->getUniformLocation("uniPointPositions")),
-    directionalDirectionsUniformLocation(this->getUniformLocation("uniDirectionalDirections")),
-    spotPositionsUniformLocation(this->getUniformLocation("uniSpotPositions")),
-    spotDirectionsUniformLocation(this->getUniformLocation("uniSpotDirections")),
-    spotCutoffsUniformLocation(this->getUniformLocation("uniSpotCutoffs")) {}
-
-void ShadedShaderProgram::setFullMatrix(const glm::mat4 &fullMatrix) const {
-    glUniformMatrix4fv(this->fullMatrixUniformLocation, 1, false, glm::value_ptr(fullMatrix));
-}
-
-void ShadedShaderProgram::setWorldMatrix(const glm::mat4 &worldMatrix) const {
-    glUniformMatrix4fv(this->worldMatrixUniformLocation, 1, false, glm::value_ptr(worldMatrix));
-}
-
-void ShadedShaderProgram::setNormalMatrix(const glm::mat4 &normalMatrix) const {
-    glUniformMatrix4fv(this->normalMatrixUniformLocation, 1, false, glm::value_ptr(normalMatrix));
-}
-
-void ShadedShaderProgram::setCameraPosition(const glm::vec3 &position) const {
-    glUniform3f(this->cameraPositionUniformLocation, position.x, position.y, position.z);
-}
-
-void ShadedShaderProgram::setTexture(const Texture &texture,
-                                     const scene::Material &material) const {
-    this->setMaterial(material);
-    glUniform1i(this->texturedUniformLocation, true);
-    texture.use();
-}
-
-void ShadedShaderProgram::setMaterial(const scene::Material &material) const {
-    glUniform1i(this->texturedUniformLocation, false);
-
-    const glm::vec3 &diffuse = material.getDiffuse();
-    glUniform3f(this->diffuseUniformLocation, diffuse.r, diffuse.g, diffuse.b);
-
-    const glm::vec3 &ambient = material.getAmbient();
-    glUniform3f(this->ambientUniformLocation, ambient.r, ambient.g, ambient.b);
+ShadedShaderProgram::ShadedShaderProgram() :
+    ShaderProgram(ShadedShaderProgram::initializeVertexShader(),
+                  ShadedShaderProgram::initializeFragmentShader()) {}
 
-    const glm::vec3 &specular = material.getSpecular();
-    glUniform3f(this->specularUniformLocation, specular.r, specular.g, specular.b);
-
-    const glm::vec3 &emissive = material.getEmissive();
-    glUniform3f(this->emissiveUniformLocation, emissive.r, emissive.g, emissive.b);
-
-    glUniform1f(this->shininessUniformLocation, material.getShininess());
+void ShadedShaderProgram::setFirstDraw(GLuint firstDraw) const {
+    glUniform1ui(ShadedShaderProgram::firstDrawUniformLocation, firstDraw);
 }
 
-void ShadedShaderProgram::setLights(
-    const std::vector<std::unique_ptr<scene::light::Light>> &lights) const {
-    int pointLightCount = 0, directionalLightCount = 0, spotlightCount = 0;
-
-    for (const std::unique_ptr<scene::light::Light> &light : lights) {
-        if (dynamic_cast<scene::light::PointLight *>(light.get())) {
-            scene::light::PointLight pointLight = dynamic_cast<scene::light::PointLight &>(*light);
-
-            const glm::vec3 &position = pointLight.getPosition();
-            glUniform3f(this->pointPositionsUniformLocation + pointLightCount,
-                        position.x,
-                        position.y,
-                        position.z);
-
-            pointLightCount++;
-        } else if (dynamic_cast<scene::light::DirectionalLight *>(light.get())) {
-            scene::light::DirectionalLight directionalLight =
-                dynamic_cast<scene::light::DirectionalLight &>(*light);
-
-            const glm::vec3 &direction = directionalLight.getDirection();
-            glUniform3f(this->directionalDirectionsUniformLocation + directionalLightCount,
-                        direction.x,
-                        direction.y,
-                        direction.z);
-
-            directionalLightCount++;
-        } else if (dynamic_cast<scene::light::Spotlight *>(light.get())) {
-            scene::light::Spotlight spotlight = dynamic_cast<scene::light::Spotlight &>(*light);
-
-            const glm::vec3 &position = spotlight.getPosition();
-            glUniform3f(this->spotPositionsUniformLocation + spotlightCount,
-                        position.x,
-                        position.y,
-                        position.z);
-
-            const glm::vec3 &direction = spotlight.getDirection();
-            glUniform3f(this->spotDirectionsUniformLocation + spotlightCount,
-                        direction.x,
-                        direction.y,
-                        direction.z);
-
-            const float cutoffAngle = spotlight.getCutoff();
-            glUniform1f(this->spotCutoffsUniformLocation + spotlightCount, cosf(cutoffAngle));
-
-            spotlightCount++;
-        }
-    }
-
-    if (pointLightCount != this->pointLights || directionalLightCount != this->directionalLights ||
-        spotlightCount != this->spotlights) {
-
-        throw std::runtime_error("ShadedShaderProgram got wrong number of lights");
-    }
+std::string ShadedShaderProgram::initializeVertexShader() {
+    std::stringstream ss;
+    ss << "#version 460 core" << std::endl;
+    ss << ShadedShaderProgram::commonSource;
+    ss << ShadedShaderProgram::vertexShaderSource;
+    return ss.str();
 }
 
-std::string ShadedShaderProgram::initializeFragmentShader(int _pointLights,
-                                                          int _directionalLights,
-                                                          int _spotlights) {
+std::string ShadedShaderProgram::initializeFragmentShader() {
+    // The light grid's size is fixed, so that lights can be changed without recompiling
     std::stringstream ss;
     ss << "#version 460 core" << std::endl;
-    ss << "#define NUM_DIRECTIONAL_LIGHTS " << _directionalLights << std::endl;
-    ss << "#define NUM_POINT_LIGHTS " << _pointLights << std::endl;
-    ss << "#define NUM_SPOTLIGHTS " << _spotlights << std::endl;
+    ss << "#define CLUSTER_COLUMNS " << LightGrid::columns << std::endl;
+    ss << "#define CLUSTER_ROWS " << LightGrid::rows << std::endl;
+    ss << "#define CLUSTER_SLICES " << LightGrid::slices << std::endl;
+    ss << "#define CLUSTER_COUNT " << LightGrid::clusterCount << std::endl;
+    ss << ShadedShaderProgram::commonSource;
     ss << ShadedShaderProgram::fragmentShaderSource;
     return ss.str();
 }
 
-const std::string ShadedShaderProgram::vertexShaderSource = R"(
-#version 460 core
+const std::string ShadedShaderProgram::commonSource = R"(
+layout (std140, binding = 0) uniform FrameBlock {
+    mat4 uniCameraMatrix;   // PV
+    vec3 uniCameraPosition; // World space
+    float uniClusterScale;  // Turn the logarithm of a view depth into a cluster slice
+    float uniClusterBias;
+};
 
+struct Draw {
+    mat4 positionDecodeMatrix;
+    vec4 textureCoordinateDecode; // Scale (xy) and offset (zw)
+    uint textured;
+    uint octahedralNormals;
+};
+
+layout (std430, binding = 1) readonly buffer DrawBuffer {
+    Draw draws[];
+};
+)";
+
+const std::string ShadedShaderProgram::vertexShaderSource = R"(
 layout (location = 0) in vec4 inPosition;          // Local space
 layout (location = 1) in vec2 inTextureCoordinate;
-layout (location = 2) in vec3 inNormal;            // Local space
+layout (location = 2) in vec4 inNormal;            // Local space (xyz or octahedral xy)
 
 layout (location = 0) out vec2 outTextureCoordinate;
 layout (location = 1) out vec3 outNormal;            // World space
 layout (location = 2) out vec3 outFragmentPosition;  // World space
+layout (location = 3) flat out uint outDraw;
+layout (location = 4) flat out uint outMaterial;
+
+// The depth pre-pass runs this same shader, and must produce the exact same depth
+invariant gl_Position;
 
-uniform mat4 uniFullMatrix;   // PVM
-uniform mat4 uniWorldMatrix;  // M
-uniform mat4 uniNormalMatrix; // (M^T)^(-1)
+struct Instance {
+    mat4 worldMatrix;  // M
+    mat4 normalMatrix; // (M^T)^(-1)
+    uint material;     // Index in the material table
+};
+
+layout (std430, binding = 0) readonly buffer InstanceBuffer {
+    Instance instances[];
+};
+
+layout (location = 0) uniform uint uniFirstDraw; // gl_DrawID restarts on every multi-draw call
+
+vec3 decodeOctahedral(vec2 encoded) {
+    vec3 normal = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+    float fold = max(-normal.z, 0.0);
+    normal.xy += vec2(normal.x >= 0.0 ? -fold : fold, normal.y >= 0.0 ? -fold : fold);
+    return normal;
+}
 
 void main() {
-    gl_Position = uniFullMatrix * inPosition;                // Clip space
-    outTextureCoordinate = inTextureCoordinate;
-    outNormal = normalize(mat3(uniNormalMatrix) * inNormal); // World space
-    outFragmentPosition = vec3(uniWorldMatrix * inPosition); // World space
+    uint drawIndex = uniFirstDraw + gl_DrawID;
+    Draw draw = draws[drawIndex];
+    Instance instance = instances[gl_BaseInstance + gl_InstanceID];
+
+    vec4 position = instance.worldMatrix * (draw.positionDecodeMatrix * inPosition);
+    vec3 normal = draw.octahedralNormals != 0 ? decodeOctahedral(inNormal.xy) : inNormal.xyz;
+
+    gl_Position = uniCameraMatrix * position;                     // Clip space
+    outTextureCoordinate =
+        inTextureCoordinate * draw.textureCoordinateDecode.xy + draw.textureCoordinateDecode.zw;
+    outNormal = normalize(mat3(instance.normalMatrix) * normal);  // World space
+    outFragmentPosition = vec3(position);                         // World space
+    outDraw = drawIndex;
+    outMaterial = instance.material;
 }
 )";
 
@@ -187,16 +125,43 @@ const std::string ShadedShaderProgram::fragmentShaderSource = R"(
 layout (location = 0) in vec2 inTextureCoordinate;
 layout (location = 1) in vec3 inNormal;            // World space
 layout (location = 2) in vec3 inFragmentPosition;  // World space
+layout (location = 3) flat in uint inDraw;
+layout (location = 4) flat in uint inMaterial;
 
 layout (location = 0) out vec4 outColor;
 
-uniform vec3 uniCameraPosition; // World space
-uniform bool uniTextured;
-uniform vec3 uniDiffuse;
-uniform vec3 uniAmbient;
-uniform vec3 uniSpecular;
-uniform vec3 uniEmissive;
-uniform float uniShininess;
+struct Material {
+    vec3 diffuse;
+    float shininess;
+    vec3 ambient;
+    vec3 specular;
+    vec3 emissive;
+};
+
+// Every material in the scene, uploaded once
+layout (std430, binding = 2) readonly buffer MaterialBuffer {
+    Material materials[];
+};
+
+struct Light {
+    vec3 position;  // World space (point lights and spotlights)
+    float cutoff;   // Cosine of the cutoff angle (spotlights), -1 for point lights
+    vec3 direction; // World space (directional lights and spotlights)
+    float range;    // Distance at which the light fades out (point lights and spotlights)
+};
+
+// Directional lights come first, as they reach every fragment
+layout (std430, binding = 3) readonly buffer LightBuffer {
+    uint directionalLightCount;
+    Light lights[];
+};
+
+layout (std430, binding = 4) readonly buffer ClusterBuffer {
+    uvec2 clusters[CLUSTER_COUNT]; // First light and light count in clusterLights
+    uint clusterLights[];
+};
+
+Material material;
 
 struct ColorPair {
     vec3 regularColor;
@@ -207,100 +172,79 @@ ColorPair light(vec3 normal, vec3 lightDirection, vec3 cameraDirection) {
     ColorPair ret = ColorPair(vec3(0.0f), vec3(0.0f));
 
     float intensity = max(dot(normal, lightDirection), 0.0);
-    ret.regularColor = intensity * uniDiffuse;
+    ret.regularColor = intensity * material.diffuse;
 
-    if (intensity > 0.0f && uniShininess > 0.0f) {
+    if (intensity > 0.0f && material.shininess > 0.0f) {
         vec3 reflectDirection = reflect(-lightDirection, normal);
         float specularIntensity = max(dot(cameraDirection, reflectDirection), 0.0);
-        ret.specularColor = uniSpecular * pow(specularIntensity, uniShininess);
+        ret.specularColor = material.specular * pow(specularIntensity, material.shininess);
     }
 
     return ret;
 }
 
-#if NUM_POINT_LIGHTS > 0
-uniform vec3 uniPointPositions[NUM_POINT_LIGHTS]; // World space
-
-ColorPair point(vec3 normal, vec3 cameraDirection) {
+ColorPair directional(vec3 normal, vec3 cameraDirection) {
     ColorPair ret = ColorPair(vec3(0.0f), vec3(0.0f));
-    for (uint i = 0; i < NUM_POINT_LIGHTS; ++i) {
-        vec3 lightDirection = normalize(uniPointPositions[i] - inFragmentPosition);
-
+    for (uint i = 0; i < directionalLightCount; ++i) {
+        vec3 lightDirection = lights[i].direction;
         ColorPair lightColor = light(normal, lightDirection, cameraDirection);
         ret.regularColor += lightColor.regularColor;
         ret.specularColor += lightColor.specularColor;
     }
     return ret;
 }
-#else
-ColorPair point(vec3 normal, vec3 cameraDirection) {
-    return ColorPair(vec3(0.0f), vec3(0.0f));
-}
-#endif
 
-#if NUM_DIRECTIONAL_LIGHTS > 0
-uniform vec3 uniDirectionalDirections[NUM_DIRECTIONAL_LIGHTS]; // World space
+// Point lights and spotlights in this fragment's cluster
+ColorPair clustered(vec3 normal, vec3 cameraDirection) {
+    vec4 clipPosition = uniCameraMatrix * vec4(inFragmentPosition, 1.0f);
+    vec2 tile =
+        (clipPosition.xy / clipPosition.w * 0.5f + 0.5f) * vec2(CLUSTER_COLUMNS, CLUSTER_ROWS);
+    int slice = int(floor(log(clipPosition.w) * uniClusterScale + uniClusterBias));
 
-ColorPair directional(vec3 normal, vec3 cameraDirection) {
-    ColorPair ret = ColorPair(vec3(0.0f), vec3(0.0f));
-    for (uint i = 0; i < NUM_DIRECTIONAL_LIGHTS; ++i) {
-        ColorPair lightColor = light(normal, uniDirectionalDirections[i], cameraDirection);
-        ret.regularColor += lightColor.regularColor;
-        ret.specularColor += lightColor.specularColor;
-    }
-    return ret;
-}
-#else
-ColorPair directional(vec3 normal, vec3 cameraDirection) {
-    return ColorPair(vec3(0.0f), vec3(0.0f));
-}
-#endif
-
-#if NUM_SPOTLIGHTS > 0
-uniform vec3 uniSpotPositions[NUM_SPOTLIGHTS]; // World space
-uniform vec3 uniSpotDirections[NUM_SPOTLIGHTS]; // World space
-uniform float uniSpotCutoffs[NUM_SPOTLIGHTS];
+    ivec3 cell = clamp(ivec3(ivec2(tile), slice),
+                       ivec3(0),
+                       ivec3(CLUSTER_COLUMNS - 1, CLUSTER_ROWS - 1, CLUSTER_SLICES - 1));
+    uvec2 cluster = clusters[(cell.z * CLUSTER_ROWS + cell.y) * CLUSTER_COLUMNS + cell.x];
 
-ColorPair spot(vec3 normal, vec3 cameraDirection) {
     ColorPair ret = ColorPair(vec3(0.0f), vec3(0.0f));
-    for (uint i = 0; i < NUM_SPOTLIGHTS; ++i) {
-        vec3 lightDirection = normalize(uniSpotPositions[i] - inFragmentPosition);
-        float angle = max(dot(lightDirection, -uniSpotDirections[i]), 0.0f);
+    for (uint i = 0; i < cluster.y; ++i) {
+        Light clusterLight = lights[clusterLights[cluster.x + i]];
+        vec3 lightVector = clusterLight.position - inFragmentPosition;
+        float distance = length(lightVector);
+        vec3 lightDirection = lightVector / distance;
+        float angle = max(dot(lightDirection, -clusterLight.direction), 0.0f);
+
+        if (angle > clusterLight.cutoff && distance < clusterLight.range) {
+            // Smooth fade to zero at the range, so that clusters can leave the light out
+            float fade = 1.0f - pow(distance / clusterLight.range, 4.0f);
+            fade *= fade;
 
-        if (angle > uniSpotCutoffs[i]) {
             ColorPair lightColor = light(normal, lightDirection, cameraDirection);
-            ret.regularColor += lightColor.regularColor;
-            ret.specularColor += lightColor.specularColor;
+            ret.regularColor += fade * lightColor.regularColor;
+            ret.specularColor += fade * lightColor.specularColor;
         }
     }
     return ret;
 }
-#else
-ColorPair spot(vec3 normal, vec3 cameraDirection) {
-    return ColorPair(vec3(0.0f), vec3(0.0f));
-}
-#endif
 
 uniform sampler2D uniSampler;
 
 void main() {
+    material = materials[inMaterial];
     vec3 normal = normalize(inNormal);
     vec3 cameraDirection = normalize(uniCameraPosition - inFragmentPosition);
 
-    ColorPair pointColors = point(normal, cameraDirection);
     ColorPair directionalColors = directional(normal, cameraDirection);
-    ColorPair spotColors = spot(normal, cameraDirection);
+    ColorPair clusteredColors = clustered(normal, cameraDirection);
 
-    vec3 regularColor = pointColors.regularColor +
-                        directionalColors.regularColor +
-                        spotColors.regularColor +
-                        uniAmbient +
-                        uniEmissive;
+    vec3 regularColor = directionalColors.regularColor +
+                        clusteredColors.regularColor +
+                        material.ambient +
+                        material.emissive;
 
-    vec3 specularColor =
-        pointColors.specularColor + directionalColors.specularColor + spotColors.specularColor;
+    vec3 specularColor = directionalColors.specularColor + clusteredColors.specularColor;
 
-    if (uniTextured) {
+    if (draws[inDraw].textured != 0) {
         vec3 textureColor = vec3(texture(uniSampler, inTextureCoordinate));
         outColor = vec4(textureColor * regularColor + specularColor, 1.0f);
     } else {
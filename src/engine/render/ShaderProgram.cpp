@@ -12,27 +12,68 @@
 /// See the License for the specific language governing permissions and
 /// limitations under the License.
 
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <GLFW/glfw3.h>
+#include <iomanip>
+#include <sstream>
 #include <stdexcept>
+#include <vector>
 
 #include "engine/render/ShaderProgram.hpp"
+#include "utils/MappedFile.hpp"
+
+// From GL_KHR_parallel_shader_compile, not present in the loader
+typedef void(APIENTRYP PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)(GLuint count);
 
 namespace engine::render {
 
 ShaderProgram::ShaderProgram(const std::string &vertexShaderSource,
-                             const std::string &fragmentShaderSource) {
-    // Compile shaders
+                             const std::string &fragmentShaderSource) :
+    vertexShader(0),
+    fragmentShader(0),
+    program(glCreateProgram()),
+    binaryPath(ShaderProgram::getBinaryPath(vertexShaderSource, fragmentShaderSource)),
+    linked(false) {
+
+    if (this->loadBinary()) {
+        this->binaryPath.clear();
+        this->linked = true;
+        return;
+    }
+
+    // Cache miss: compile without waiting for any results, so that the driver can do it in the
+    // background while other programs are compiled
+    ShaderProgram::enableParallelCompilation();
     this->vertexShader = this->compileShader(GL_VERTEX_SHADER, vertexShaderSource);
     this->fragmentShader = this->compileShader(GL_FRAGMENT_SHADER, fragmentShaderSource);
 
-    // Link program
-    this->program = glCreateProgram();
     glAttachShader(this->program, this->vertexShader);
     glAttachShader(this->program, this->fragmentShader);
+    glProgramParameteri(this->program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
     glLinkProgram(this->program);
+}
+
+ShaderProgram::~ShaderProgram() {
+    glDeleteShader(this->vertexShader);
+    glDeleteShader(this->fragmentShader);
+    glDeleteProgram(this->program);
+}
+
+void ShaderProgram::waitForLinking() const {
+    if (this->linked) {
+        return;
+    }
 
     GLint success;
     glGetProgramiv(this->program, GL_LINK_STATUS, &success);
     if (!success) {
+        // Compilation errors are only found out now, and explain why linking failed
+        ShaderProgram::checkShader(this->vertexShader);
+        ShaderProgram::checkShader(this->fragmentShader);
+
         GLint logLength;
         glGetProgramiv(this->program, GL_INFO_LOG_LENGTH, &logLength);
 
@@ -42,20 +83,90 @@ ShaderProgram::ShaderProgram(const std::string &vertexShaderSource,
 
         throw std::runtime_error("Shader linking error: " + logMessage);
     }
-}
 
-ShaderProgram::~ShaderProgram() {
-    glDeleteShader(this->vertexShader);
-    glDeleteShader(this->fragmentShader);
-    glDeleteProgram(this->program);
+    // Failing to store the binary (e.g.: read-only directory) only makes the next start slower
+    try {
+        this->storeBinary();
+    } catch (const std::exception &) {
+        std::error_code error;
+        std::filesystem::remove(this->binaryPath + ".tmp", error);
+    }
+
+    this->linked = true;
 }
 
 void ShaderProgram::use() const {
+    this->waitForLinking();
     glUseProgram(this->program);
 }
 
-GLint ShaderProgram::getUniformLocation(const std::string &name) {
-    return glGetUniformLocation(program, name.c_str());
+bool ShaderProgram::loadBinary() {
+    GLint formatCount;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+    if (formatCount == 0) {
+        this->binaryPath.clear(); // Binaries aren't supported, so there's no point in storing
+        return false;
+    }
+
+    const utils::MappedFile file(this->binaryPath);
+    if (!file.isOpen() || file.getSize() < sizeof(BinaryHeader)) {
+        return false;
+    }
+
+    BinaryHeader header;
+    std::memcpy(&header, file.getData(), sizeof(BinaryHeader));
+    if (std::memcmp(header.magic, ShaderProgram::binaryMagic, sizeof(header.magic)) != 0 ||
+        file.getSize() != sizeof(BinaryHeader) + header.length) {
+
+        return false;
+    }
+
+    // The driver may still refuse the binary (e.g.: after an update that kept the version string)
+    glProgramBinary(this->program,
+                    header.format,
+                    file.getData() + sizeof(BinaryHeader),
+                    header.length);
+
+    GLint success;
+    glGetProgramiv(this->program, GL_LINK_STATUS, &success);
+    return success;
+}
+
+void ShaderProgram::storeBinary() const {
+    if (this->binaryPath.empty()) {
+        return;
+    }
+
+    GLint length;
+    glGetProgramiv(this->program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) {
+        return;
+    }
+
+    std::vector<char> binary(length);
+    GLenum format;
+    glGetProgramBinary(this->program, length, nullptr, &format, binary.data());
+
+    BinaryHeader header;
+    std::memcpy(header.magic, ShaderProgram::binaryMagic, sizeof(header.magic));
+    header.format = format;
+    header.length = length;
+
+    // Write to a temporary file first, so that an interrupted write can't leave a broken binary
+    const std::filesystem::path path(this->binaryPath);
+    const std::string temporaryPath = this->binaryPath + ".tmp";
+    std::filesystem::create_directories(path.parent_path());
+    {
+        std::ofstream binaryFile;
+        binaryFile.exceptions(std::ofstream::failbit | std::ofstream::badbit);
+        binaryFile.open(temporaryPath, std::ios::out | std::ios::trunc | std::ios::binary);
+
+        binaryFile.write(reinterpret_cast<const char *>(&header), sizeof(BinaryHeader));
+        binaryFile.write(binary.data(), binary.size());
+        binaryFile.close();
+    }
+
+    std::filesystem::rename(temporaryPath, path);
 }
 
 GLuint ShaderProgram::compileShader(GLenum type, const std::string &source) {
@@ -63,7 +174,10 @@ GLuint ShaderProgram::compileShader(GLenum type, const std::string &source) {
     const char *rawSource = source.c_str();
     glShaderSource(shader, 1, &rawSource, nullptr);
     glCompileShader(shader);
+    return shader;
+}
 
+void ShaderProgram::checkShader(GLuint shader) {
     GLint success;
     glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
     if (!success) {
@@ -76,8 +190,67 @@ GLuint ShaderProgram::compileShader(GLenum type, const std::string &source) {
 
         throw std::runtime_error("Shader compilation error: " + logMessage);
     }
+}
+
+std::string ShaderProgram::getBinaryPath(const std::string &vertexShaderSource,
+                                         const std::string &fragmentShaderSource) {
+
+    // Binaries are only valid for the driver that created them
+    uint64_t hash = 0xcbf29ce484222325;
+    hash = ShaderProgram::hashString(vertexShaderSource.c_str(), hash);
+    hash = ShaderProgram::hashString(fragmentShaderSource.c_str(), hash);
+    for (GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION }) {
+        hash = ShaderProgram::hashString(reinterpret_cast<const char *>(glGetString(name)), hash);
+    }
 
-    return shader;
+    std::filesystem::path directory;
+    const char *cacheHome = std::getenv("XDG_CACHE_HOME");
+    const char *home = std::getenv("HOME");
+    if (cacheHome && *cacheHome) {
+        directory = cacheHome;
+    } else if (home && *home) {
+        directory = std::filesystem::path(home) / ".cache";
+    } else {
+        directory = std::filesystem::temp_directory_path();
+    }
+
+    std::stringstream filename;
+    filename << std::hex << std::setw(16) << std::setfill('0') << hash << ".bin";
+    return (directory / "cg" / "shaders" / filename.str()).string();
+}
+
+uint64_t ShaderProgram::hashString(const char *str, uint64_t hash) {
+    // FNV-1a, including the terminator, so that the concatenation of strings is unambiguous
+    do {
+        hash = (hash ^ static_cast<uint8_t>(*str)) * 0x100000001b3;
+    } while (*str++);
+
+    return hash;
+}
+
+void ShaderProgram::enableParallelCompilation() {
+    static bool enabled = false;
+    if (enabled) {
+        return;
+    }
+    enabled = true;
+
+    GLint extensionCount;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+    for (GLint i = 0; i < extensionCount; ++i) {
+        const char *extension = reinterpret_cast<const char *>(glGetStringi(GL_EXTENSIONS, i));
+        if (std::strcmp(extension, "GL_KHR_parallel_shader_compile") == 0) {
+            // Let the driver pick the number of threads
+            const PFNGLMAXSHADERCOMPILERTHREADSKHRPROC maxShaderCompilerThreads =
+                reinterpret_cast<PFNGLMAXSHADERCOMPILERTHREADSKHRPROC>(
+                    glfwGetProcAddress("glMaxShaderCompilerThreadsKHR"));
+
+            if (maxShaderCompilerThreads) {
+                maxShaderCompilerThreads(0xffffffff);
+            }
+            return;
+        }
+    }
 }
 
 }
@@ -20,23 +20,24 @@ namespace engine::render {
 
 SolidColorShaderProgram::SolidColorShaderProgram() :
     ShaderProgram(SolidColorShaderProgram::vertexShaderSource,
-                  SolidColorShaderProgram::fragmentShaderSource),
-    fullMatrixUniformLocation(this->getUniformLocation("uniFullMatrix")),
-    colorUniformLocation(this->getUniformLocation("uniColor")) {}
+                  SolidColorShaderProgram::fragmentShaderSource) {}
 
 void SolidColorShaderProgram::setFullMatrix(const glm::mat4 &fullMatrix) const {
-    glUniformMatrix4fv(this->fullMatrixUniformLocation, 1, false, glm::value_ptr(fullMatrix));
+    glUniformMatrix4fv(SolidColorShaderProgram::fullMatrixUniformLocation,
+                       1,
+                       false,
+                       glm::value_ptr(fullMatrix));
 }
 
 void SolidColorShaderProgram::setColor(const glm::vec4 &color) const {
-    glUniform4f(this->colorUniformLocation, color.x, color.y, color.z, color.w);
+    glUniform4f(SolidColorShaderProgram::colorUniformLocation, color.x, color.y, color.z, color.w);
 }
 
 const std::string SolidColorShaderProgram::vertexShaderSource = R"(
 #version 460 core
 layout (location = 0) in vec4 inPosition; // Local space
 
-uniform mat4 uniFullMatrix; // PVM
+layout (location = 0) uniform mat4 uniFullMatrix; // PVM
 
 void main() {
     gl_Position = uniFullMatrix * inPosition; // Clip space
@@ -47,7 +48,7 @@ const std::string SolidColorShaderProgram::fragmentShaderSource = R"(
 #version 460 core
 layout (location = 0) out vec4 outColor;
 
-uniform vec4 uniColor;
+layout (location = 1) uniform vec4 uniColor;
 
 void main() {
     outColor = uniColor;
@@ -12,16 +12,21 @@
 /// See the License for the specific language governing permissions and
 /// limitations under the License.
 
+#include <algorithm>
+#include <glm/gtc/constants.hpp>
+
 #include "engine/scene/Entity.hpp"
 
-#include "utils/WavefrontOBJ.hpp"
+#include "engine/render/MeshCache.hpp"
 
 namespace engine::scene {
 
 Entity::Entity(const tinyxml2::XMLElement *modelElement,
                const std::filesystem::path &sceneDirectory,
+               render::VertexFormat vertexFormat,
                std::unordered_map<std::string, std::shared_ptr<render::Model>> &loadedModels,
-               std::unordered_map<std::string, std::shared_ptr<render::Texture>> &loadedTextures) {
+               std::unordered_map<std::string, std::shared_ptr<render::Texture>> &loadedTextures,
+               std::vector<Material> &loadedMaterials) {
 
     // Get model
     const char *file = modelElement->Attribute("file");
@@ -33,13 +38,27 @@ Entity::Entity(const tinyxml2::XMLElement *modelElement,
     this->name = nameAttribute ? std::string(nameAttribute) : "";
 
     const std::string modelPath = std::filesystem::canonical(sceneDirectory / file);
-    auto modelIt = loadedModels.find(modelPath);
-    if (modelIt == loadedModels.end()) {
-        utils::WavefrontOBJ object(modelPath);
-        this->model = std::make_shared<render::Model>(object);
-        loadedModels[modelPath] = model;
-    } else {
-        this->model = modelIt->second;
+    this->model = Entity::loadModel(modelPath, vertexFormat, loadedModels);
+
+    // Optional levels of detail, from the most to the least detailed
+    std::string leastDetailedPath = modelPath;
+    const tinyxml2::XMLElement *lodElement = modelElement->FirstChildElement("lod");
+    while (lodElement) {
+        const char *lodFile = lodElement->Attribute("file");
+        if (!lodFile) {
+            throw std::runtime_error("<lod> missing file attribute in scene XML file");
+        }
+
+        const std::string lodPath = std::filesystem::canonical(sceneDirectory / lodFile);
+        this->lods.push_back(Entity::loadModel(lodPath, vertexFormat, loadedModels));
+        leastDetailedPath = lodPath;
+        lodElement = lodElement->NextSiblingElement("lod");
+    }
+
+    // Optional software occluder, with the least detailed level's triangles
+    if (modelElement->BoolAttribute("occluder", false)) {
+        this->occluder =
+            std::make_unique<render::OccluderMesh>(render::MeshCache(leastDetailedPath));
     }
 
     // Optional texture
@@ -60,19 +79,22 @@ Entity::Entity(const tinyxml2::XMLElement *modelElement,
         }
     }
 
-    // Optional material
+    // Optional material, shared with all entities with the same colors
+    Material material;
     const tinyxml2::XMLElement *colorElement = modelElement->FirstChildElement("color");
     if (colorElement) {
-        this->material = Material(colorElement);
+        material = Material(colorElement);
     }
-}
 
-void Entity::updateBoundingSphere(const glm::mat4 &worldTransform) {
-    this->boundingSphere = render::BoundingSphere(this->model->getBoundingSphere(), worldTransform);
+    auto materialIt = std::find(loadedMaterials.cbegin(), loadedMaterials.cend(), material);
+    this->materialIndex = materialIt - loadedMaterials.cbegin();
+    if (materialIt == loadedMaterials.cend()) {
+        loadedMaterials.push_back(material);
+    }
 }
 
-const render::BoundingSphere &Entity::getBoundingSphere() const {
-    return this->boundingSphere;
+const render::BoundingSphere &Entity::getModelBoundingSphere() const {
+    return this->model->getBoundingSphere();
 }
 
 const render::NormalsPreview &Entity::getNormalsPreview() const {
@@ -91,21 +113,70 @@ void Entity::drawSolidColor(render::RenderPipelineManager &pipelineManager,
     this->model->drawSolidColor(pipelineManager, fullMatrix, color, fillPolygons);
 }
 
-void Entity::draw(render::RenderPipelineManager &pipelineManager,
+bool Entity::draw(render::RenderPipelineManager &pipelineManager,
+                  render::InstanceBatcher &instanceBatcher,
+                  const camera::Camera &camera,
+                  const render::BoundingSphere &boundingSphere,
                   const glm::mat4 &fullMatrix,
                   const glm::mat4 &worldMatrix,
                   const glm::mat4 &normalMatrix,
                   bool fillPolygons) const {
 
+    const float projectedSize = camera.getProjectedSize(boundingSphere);
+    if (projectedSize < camera.getMinimumProjectedSize()) {
+        return false;
+    }
+
+    // Pick the most detailed level whose triangles aren't smaller than the desired size. Only
+    // about half of the triangles face the camera.
+    const float projectedArea = glm::pi<float>() * projectedSize * projectedSize / 4.0f;
+    const float triangleSize = camera.getLODTriangleSize();
+    const float maximumTriangles = 2.0f * projectedArea / (triangleSize * triangleSize);
+
+    const render::Model *level = this->model.get();
+    for (const std::shared_ptr<render::Model> &lod : this->lods) {
+        if (level->getTriangleCount() <= maximumTriangles) {
+            break;
+        }
+        level = lod.get();
+    }
+
     if (fillPolygons) {
-        this->model->drawShaded(pipelineManager,
-                                fullMatrix,
-                                worldMatrix,
-                                normalMatrix,
-                                this->texture,
-                                this->material);
+        instanceBatcher.add(*level,
+                            this->texture,
+                            this->materialIndex,
+                            fullMatrix,
+                            worldMatrix,
+                            normalMatrix);
+    } else {
+        level->drawSolidColor(pipelineManager, fullMatrix, glm::vec4(1.0f), false);
+    }
+
+    return true;
+}
+
+void Entity::addOccluder(render::OcclusionCuller &occlusionCuller,
+                         const glm::mat4 &fullMatrix) const {
+
+    if (this->occluder) {
+        occlusionCuller.addOccluder(*this->occluder, fullMatrix);
+    }
+}
+
+std::shared_ptr<render::Model> Entity::loadModel(
+    const std::string &modelPath,
+    render::VertexFormat vertexFormat,
+    std::unordered_map<std::string, std::shared_ptr<render::Model>> &loadedModels) {
+
+    auto modelIt = loadedModels.find(modelPath);
+    if (modelIt == loadedModels.end()) {
+        const render::MeshCache mesh(modelPath);
+        const std::shared_ptr<render::Model> model =
+            std::make_shared<render::Model>(mesh, vertexFormat);
+        loadedModels[modelPath] = model;
+        return model;
     } else {
-        this->drawSolidColor(pipelineManager, fullMatrix, glm::vec4(1.0f), false);
+        return modelIt->second;
     }
 }
 
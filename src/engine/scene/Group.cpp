@@ -12,7 +12,6 @@
 /// See the License for the specific language governing permissions and
 /// limitations under the License.
 
-#include <numeric>
 #include <stdexcept>
 
 #include "engine/scene/Group.hpp"
@@ -21,8 +20,10 @@ namespace engine::scene {
 
 Group::Group(const tinyxml2::XMLElement *groupElement,
              const std::filesystem::path &sceneDirectory,
+             render::VertexFormat vertexFormat,
              std::unordered_map<std::string, std::shared_ptr<render::Model>> &loadedModels,
-             std::unordered_map<std::string, std::shared_ptr<render::Texture>> &loadedTextures) {
+             std::unordered_map<std::string, std::shared_ptr<render::Texture>> &loadedTextures,
+             std::vector<Material> &loadedMaterials) {
 
     // Parse entities
     const tinyxml2::XMLElement *modelsElement = groupElement->FirstChildElement("models");
@@ -35,8 +36,10 @@ Group::Group(const tinyxml2::XMLElement *groupElement,
         while (modelElement) {
             this->entities.push_back(std::make_unique<Entity>(modelElement,
                                                               sceneDirectory,
+                                                              vertexFormat,
                                                               loadedModels,
-                                                              loadedTextures));
+                                                              loadedTextures,
+                                                              loadedMaterials));
             modelElement = modelElement->NextSiblingElement("model");
         }
     }
@@ -46,8 +49,10 @@ Group::Group(const tinyxml2::XMLElement *groupElement,
     while (innerGroupElement) {
         this->groups.push_back(std::make_unique<Group>(innerGroupElement,
                                                        sceneDirectory,
+                                                       vertexFormat,
                                                        loadedModels,
-                                                       loadedTextures));
+                                                       loadedTextures,
+                                                       loadedMaterials));
         innerGroupElement = innerGroupElement->NextSiblingElement("group");
     }
 
@@ -58,196 +63,16 @@ Group::Group(const tinyxml2::XMLElement *groupElement,
     }
 }
 
-int Group::getEntityCount() const {
-    return std::transform_reduce(
-        this->groups.cbegin(),
-        this->groups.cend(),
-        this->entities.size(),
-        std::plus<>(),
-        [](const std::unique_ptr<Group> &group) { return group->getEntityCount(); });
+const std::vector<std::unique_ptr<Entity>> &Group::getEntities() const {
+    return this->entities;
 }
 
-void Group::update(const glm::mat4 &worldTransform, float time) {
-    this->transform.update(time);
-    const glm::mat4 subTransform = worldTransform * this->transform.getMatrix();
-    for (const std::unique_ptr<Group> &group : this->groups) {
-        group->update(subTransform, time);
-    }
-
-    this->updateBoundingSphere(worldTransform);
-}
-
-void Group::drawSolidColorParts(render::RenderPipelineManager &pipelineManager,
-                                const camera::Camera &camera,
-                                const glm::mat4 &worldTransform,
-                                bool showBoundingSpheres,
-                                bool showAnimationLines,
-                                bool showNormals) const {
-
-    const glm::mat4 &cameraMatrix = camera.getCameraMatrix();
-    const glm::mat4 fullTransform = cameraMatrix * worldTransform;
-
-    if (showAnimationLines) {
-        this->transform.draw(pipelineManager, fullTransform);
-    }
-
-    if (!(showBoundingSpheres || showAnimationLines || showNormals) ||
-        !camera.isInFrustum(this->boundingSphere)) {
-        return;
-    }
-
-    const glm::mat4 subTransform = worldTransform * this->transform.getMatrix();
-    for (const std::unique_ptr<Entity> &entity : this->entities) {
-        const render::BoundingSphere entityBoundingSphere = entity->getBoundingSphere();
-
-        if (camera.isInFrustum(entityBoundingSphere)) {
-            if (showBoundingSpheres) {
-                entityBoundingSphere.draw(pipelineManager,
-                                          cameraMatrix,
-                                          glm::vec4(1.0f, 0.0f, 0.0f, 1.0f));
-            }
-
-            if (showNormals) {
-                entity->getNormalsPreview().draw(pipelineManager,
-                                                 camera.getCameraMatrix() * subTransform,
-                                                 glm::vec4(0.0f, 0.0f, 1.0f, 1.0f));
-            }
-        }
-    }
-
-    for (const std::unique_ptr<Group> &group : this->groups) {
-        group->drawSolidColorParts(pipelineManager,
-                                   camera,
-                                   subTransform,
-                                   showBoundingSpheres,
-                                   showAnimationLines,
-                                   showNormals);
-    }
-
-    if (showBoundingSpheres) {
-        this->boundingSphere.draw(pipelineManager, cameraMatrix, glm::vec4(1.0f, 0.0f, 0.0f, 1.0f));
-    }
-}
-
-int Group::drawShadedParts(render::RenderPipelineManager &pipelineManager,
-                           const camera::Camera &camera,
-                           const glm::mat4 &worldTransform,
-                           bool fillPolygons) const {
-
-    const glm::mat4 &cameraMatrix = camera.getCameraMatrix();
-    const glm::mat4 subTransform = worldTransform * this->transform.getMatrix();
-    const glm::mat4 fullTransform = cameraMatrix * subTransform;
-    int renderedEntities = 0;
-
-    if (!camera.isInFrustum(this->boundingSphere)) {
-        return renderedEntities;
-    }
-
-    for (const std::unique_ptr<Entity> &entity : this->entities) {
-        const render::BoundingSphere entityBoundingSphere = entity->getBoundingSphere();
-
-        if (camera.isInFrustum(entityBoundingSphere)) {
-            const glm::mat4 normalMatrix = glm::inverse(glm::transpose(subTransform));
-            entity->draw(pipelineManager, fullTransform, subTransform, normalMatrix, fillPolygons);
-            renderedEntities++; // cppcheck-suppress useStlAlgorithm
-        }
-    }
-
-    for (const std::unique_ptr<Group> &group : this->groups) {
-        // cppcheck-suppress useStlAlgorithm
-        renderedEntities +=
-            group->drawShadedParts(pipelineManager, camera, subTransform, fillPolygons);
-    }
-
-    return renderedEntities;
-}
-
-int Group::drawForPicking(render::RenderPipelineManager &pipelineManager,
-                          const camera::Camera &camera,
-                          const glm::mat4 &worldTransform,
-                          std::unordered_map<int, std::string> &idToName,
-                          int currentId) const {
-
-    const glm::mat4 &cameraMatrix = camera.getCameraMatrix();
-    const glm::mat4 subTransform = worldTransform * this->transform.getMatrix();
-    const glm::mat4 fullTransform = cameraMatrix * subTransform;
-
-    if (!camera.isInFrustum(this->boundingSphere)) {
-        return currentId + this->getEntityCount();
-    }
-
-    for (const std::unique_ptr<Entity> &entity : this->entities) {
-        const render::BoundingSphere entityBoundingSphere = entity->getBoundingSphere();
-
-        if (camera.isInFrustum(entityBoundingSphere)) {
-            const glm::vec4 idColor = glm::vec4 { (currentId & 0x000000FF) / 255.0f,
-                                                  ((currentId & 0x0000FF00) >> 8) / 255.0f,
-                                                  ((currentId & 0x00FF0000) >> 16) / 255.0f,
-                                                  1.0f };
-
-            entity->drawSolidColor(pipelineManager, fullTransform, idColor, true);
-        }
-
-        idToName[currentId] = entity->getName();
-        currentId++;
-    }
-
-    for (const std::unique_ptr<Group> &group : this->groups) {
-        // cppcheck-suppress useStlAlgorithm
-        currentId =
-            group->drawForPicking(pipelineManager, camera, subTransform, idToName, currentId);
-    }
-
-    return currentId;
-}
-
-const render::BoundingSphere &Group::getBoundingSphere() const {
-    return this->boundingSphere;
-}
-
-void Group::updateBoundingSphere(const glm::mat4 &worldTransform) {
-    const glm::mat4 subTransform = worldTransform * this->transform.getMatrix();
-
-    // Calculate center of group (approximation for objects around the same size)
-    glm::vec4 groupCenter(0.0f);
-    groupCenter += this->sumBoundingSphereCenters(this->entities, subTransform);
-    groupCenter += this->sumBoundingSphereCenters(this->groups, subTransform);
-    groupCenter /= this->entities.size() + this->groups.size();
-
-    // Calculate radius of the sphere
-    const float entitiesRadius = this->calculateBoundingSphereRadius(this->entities, groupCenter);
-    const float groupsRadius = this->calculateBoundingSphereRadius(this->groups, groupCenter);
-    const float radius = std::max(entitiesRadius, groupsRadius);
-
-    this->boundingSphere = render::BoundingSphere(groupCenter, radius);
-}
-
-template<class T>
-glm::vec4 Group::sumBoundingSphereCenters(const std::vector<std::unique_ptr<T>> &ts,
-                                          const glm::mat4 &worldTransform) {
-
-    return std::transform_reduce(ts.cbegin(),
-                                 ts.cend(),
-                                 glm::vec4(0.0f),
-                                 std::plus<>(),
-                                 [worldTransform](const std::unique_ptr<T> &t) {
-                                     t->updateBoundingSphere(worldTransform);
-                                     return t->getBoundingSphere().getCenter();
-                                 });
+const std::vector<std::unique_ptr<Group>> &Group::getGroups() const {
+    return this->groups;
 }
 
-template<class T>
-float Group::calculateBoundingSphereRadius(const std::vector<std::unique_ptr<T>> &ts,
-                                           const glm::vec4 &groupCenter) {
-    return std::transform_reduce(
-        ts.cbegin(),
-        ts.cend(),
-        0.0f,
-        [](float d1, float d2) { return std::max(d1, d2); },
-        [groupCenter](const std::unique_ptr<T> &t) {
-            const render::BoundingSphere &sphere = t->getBoundingSphere();
-            return glm::distance(sphere.getCenter(), groupCenter) + sphere.getRadius();
-        });
+transform::TRSTransform &Group::getTransform() {
+    return this->transform;
 }
 
 }
@@ -25,7 +25,7 @@ Material::Material() :
     emissive(glm::vec3(0.0f)),
     shininess(0.0f) {}
 
-Material::Material(const tinyxml2::XMLElement *colorElement) {
+Material::Material(const tinyxml2::XMLElement *colorElement) : shininess(0.0f) {
     this->diffuse =
         utils::XMLUtils::getRGB(utils::XMLUtils::getSingleChild(colorElement, "diffuse"));
     this->ambient =
@@ -61,4 +61,10 @@ float Material::getShininess() const {
     return this->shininess;
 }
 
+bool Material::operator==(const Material &material) const {
+    return this->diffuse == material.diffuse && this->ambient == material.ambient &&
+        this->specular == material.specular && this->emissive == material.emissive &&
+        this->shininess == material.shininess;
+}
+
 }
@@ -12,18 +12,18 @@
 /// See the License for the specific language governing permissions and
 /// limitations under the License.
 
+#include <algorithm>
 #include <filesystem>
-#include <numeric>
+#include <glm/trigonometric.hpp>
+#include <iostream>
 #include <tinyxml2.h>
 #include <unordered_map>
+#include <vector>
 
 #include "engine/render/Model.hpp"
 #include "engine/render/Texture.hpp"
 #include "engine/scene/camera/CameraFactory.hpp"
-#include "engine/scene/light/DirectionalLight.hpp"
 #include "engine/scene/light/LightFactory.hpp"
-#include "engine/scene/light/PointLight.hpp"
-#include "engine/scene/light/Spotlight.hpp"
 #include "engine/scene/Scene.hpp"
 #include "utils/XMLUtils.hpp"
 
@@ -55,12 +55,33 @@ Scene::Scene(const std::string &file) :
         throw std::runtime_error("Invalid / unknown window width / height in scene XML file");
     }
 
+    // Get vertex format
+    render::VertexFormat vertexFormat = render::VertexFormat::Float32;
+    const tinyxml2::XMLElement *vertexFormatElement =
+        worldElement->FirstChildElement("vertexFormat");
+    if (vertexFormatElement) {
+        const char *typePtr = vertexFormatElement->Attribute("type");
+        const std::string type = typePtr ? typePtr : "";
+
+        if (type == "float32") {
+            vertexFormat = render::VertexFormat::Float32;
+        } else if (type == "float16") {
+            vertexFormat = render::VertexFormat::Float16;
+        } else if (type == "normalized16") {
+            vertexFormat = render::VertexFormat::Normalized16;
+        } else {
+            throw std::runtime_error("Invalid vertex format type in scene XML file");
+        }
+    }
+
     // Get camera properties
     this->camera = camera::CameraFactory::createFromXML(
         utils::XMLUtils::getSingleChild(worldElement, "camera"),
         sceneDirectory,
+        vertexFormat,
         loadedModels,
-        loadedTextures);
+        loadedTextures,
+        this->materials);
 
     // Get light properties
     const tinyxml2::XMLElement *lightsElement = worldElement->FirstChildElement("lights");
@@ -71,14 +92,45 @@ Scene::Scene(const std::string &file) :
             lightElement = lightElement->NextSiblingElement("light");
         }
     }
+    this->lightsChanged = true;
 
     // Get rendering groups
+    std::vector<std::unique_ptr<Group>> groups;
     const tinyxml2::XMLElement *groupElement = worldElement->FirstChildElement("group");
     while (groupElement) {
-        this->groups.push_back(
-            std::make_unique<Group>(groupElement, sceneDirectory, loadedModels, loadedTextures));
+        groups.push_back(std::make_unique<Group>(groupElement,
+                                                 sceneDirectory,
+                                                 vertexFormat,
+                                                 loadedModels,
+                                                 loadedTextures,
+                                                 this->materials));
         groupElement = groupElement->NextSiblingElement("group");
     }
+    this->graph = std::make_unique<SceneGraph>(std::move(groups));
+
+    if (vertexFormat != render::VertexFormat::Float32) {
+        Scene::reportQuantizationError(loadedModels);
+    }
+}
+
+void Scene::reportQuantizationError(
+    const std::unordered_map<std::string, std::shared_ptr<render::Model>> &loadedModels) {
+
+    std::vector<std::string> modelPaths;
+    for (const auto &[modelPath, model] : loadedModels) {
+        modelPaths.push_back(modelPath);
+    }
+    std::sort(modelPaths.begin(), modelPaths.end());
+
+    std::cout << "Maximum vertex quantization error:" << std::endl;
+    for (const std::string &modelPath : modelPaths) {
+        const render::Model::QuantizationError &error =
+            loadedModels.at(modelPath)->getQuantizationError();
+
+        std::cout << "  " << modelPath << ": position = " << error.position
+                  << ", normal = " << glm::degrees(error.normal)
+                  << " deg, texture coordinate = " << error.textureCoordinate << std::endl;
+    }
 }
 
 int Scene::getWindowWidth() const {
@@ -90,37 +142,11 @@ int Scene::getWindowHeight() const {
 }
 
 int Scene::getEntityCount() const {
-    return std::transform_reduce(
-               this->groups.cbegin(),
-               this->groups.cend(),
-               0,
-               std::plus<>(),
-               [](const std::unique_ptr<Group> &group) { return group->getEntityCount(); }) +
-        this->camera->getEntityCount();
-}
-
-int Scene::getPointLightCount() const {
-    return std::count_if(this->lights.cbegin(),
-                         this->lights.cend(),
-                         [](const std::unique_ptr<light::Light> &light) {
-                             return dynamic_cast<light::PointLight *>(light.get());
-                         });
+    return this->graph->getEntityCount() + this->camera->getEntityCount();
 }
 
-int Scene::getDirectionalLightCount() const {
-    return std::count_if(this->lights.cbegin(),
-                         this->lights.cend(),
-                         [](const std::unique_ptr<light::Light> &light) {
-                             return dynamic_cast<light::DirectionalLight *>(light.get());
-                         });
-}
-
-int Scene::getSpotlightCount() const {
-    return std::count_if(this->lights.cbegin(),
-                         this->lights.cend(),
-                         [](const std::unique_ptr<light::Light> &light) {
-                             return dynamic_cast<light::Spotlight *>(light.get());
-                         });
+const std::vector<Material> &Scene::getMaterials() const {
+    return this->materials;
 }
 
 camera::Camera &Scene::getCamera() {
@@ -133,28 +159,23 @@ void Scene::setWindowSize(int width, int height) {
     this->camera->setWindowSize(width, height);
 }
 
-void Scene::update(float time) {
-    const glm::mat4 worldTransform = glm::mat4(1.0f);
-    for (const std::unique_ptr<Group> &group : this->groups) {
-        group->update(worldTransform, time);
-    }
+void Scene::update(float time, utils::JobSystem &jobSystem) {
+    this->graph->update(glm::mat4(1.0f), time, &jobSystem);
     this->camera->updateWithTime(time);
 }
 
 int Scene::draw(render::RenderPipelineManager &pipelineManager,
+                render::InstanceBatcher &instanceBatcher,
+                render::OcclusionCuller &occlusionCuller,
                 bool fillPolygons,
                 bool backFaceCulling,
                 bool showAxes,
                 bool showBoundingSpheres,
                 bool showAnimationLines,
-                bool showNormals) const {
+                bool showNormals,
+                bool occlusionCulling) {
 
-    if (backFaceCulling) {
-        glEnable(GL_CULL_FACE);
-        glCullFace(GL_BACK);
-    } else {
-        glDisable(GL_CULL_FACE);
-    }
+    pipelineManager.setBackFaceCulling(backFaceCulling);
 
     const glm::mat4 &cameraMatrix = this->camera->getCameraMatrix();
 
@@ -171,42 +192,52 @@ int Scene::draw(render::RenderPipelineManager &pipelineManager,
                                       showAnimationLines,
                                       showNormals);
 
-    for (const std::unique_ptr<Group> &group : this->groups) {
-        group->drawSolidColorParts(pipelineManager,
-                                   *this->camera,
-                                   glm::mat4(1.0f),
-                                   showBoundingSpheres,
-                                   showAnimationLines,
-                                   showNormals);
-    }
+    this->graph->drawSolidColorParts(pipelineManager,
+                                     *this->camera,
+                                     showBoundingSpheres,
+                                     showAnimationLines,
+                                     showNormals);
 
     // Draw shaded parts
     int entityCount = 0;
 
-    const render::ShadedShaderProgram &shader = pipelineManager.getShadedShaderProgram();
-    shader.setCameraPosition(this->camera->getPosition());
-    shader.setLights(this->lights);
-
-    entityCount += this->camera->drawShadedParts(pipelineManager, fillPolygons);
-    for (const std::unique_ptr<Group> &group : this->groups) {
-        // cppcheck-suppress useStlAlgorithm
-        entityCount +=
-            group->drawShadedParts(pipelineManager, *this->camera, glm::mat4(1.0f), fillPolygons);
+    if (this->lightsChanged) {
+        pipelineManager.setLights(this->lights);
+        this->lightsChanged = false;
     }
-
+    pipelineManager.setCamera(this->camera->getViewMatrix(),
+                              this->camera->getProjectionMatrix(),
+                              this->camera->getPosition(),
+                              this->camera->getNear(),
+                              this->camera->getFar());
+
+    // Occluders are rasterized before any entity is tested against them
+    occlusionCuller.beginFrame(this->camera->getViewMatrix(),
+                               this->camera->getProjectionMatrix(),
+                               occlusionCulling);
+    this->graph->addOccluders(occlusionCuller, *this->camera);
+    occlusionCuller.rasterize();
+
+    entityCount += this->camera->drawShadedParts(pipelineManager,
+                                                 instanceBatcher,
+                                                 occlusionCuller,
+                                                 fillPolygons);
+    entityCount += this->graph->drawShadedParts(pipelineManager,
+                                                instanceBatcher,
+                                                occlusionCuller,
+                                                *this->camera,
+                                                fillPolygons);
+
+    // All visible entities are submitted at once
+    instanceBatcher.draw(pipelineManager);
     return entityCount;
 }
 
 void Scene::drawForPicking(render::RenderPipelineManager &pipelineManager,
                            std::unordered_map<int, std::string> &idToName) const {
 
-    int currentId = this->camera->drawForPicking(pipelineManager, idToName, 1);
-    const glm::mat4 identity(1.0f);
-    for (const std::unique_ptr<Group> &group : this->groups) {
-        // cppcheck-suppress useStlAlgorithm
-        currentId =
-            group->drawForPicking(pipelineManager, *this->camera, identity, idToName, currentId);
-    }
+    const int currentId = this->camera->drawForPicking(pipelineManager, idToName, 1);
+    this->graph->drawForPicking(pipelineManager, *this->camera, idToName, currentId);
 }
 
 }
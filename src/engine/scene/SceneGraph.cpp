@@ -0,0 +1,424 @@
+/// Copyright 2025 Ana Oliveira, Humberto Gomes, Mariana Rocha, Sara Lopes
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+
+#include <algorithm>
+#include <functional>
+#include <glm/geometric.hpp>
+#include <glm/matrix.hpp>
+
+#include "engine/scene/SceneGraph.hpp"
+
+namespace engine::scene {
+
+SceneGraph::SceneGraph(std::vector<std::unique_ptr<Group>> &&_roots) :
+    roots(std::move(_roots)),
+    rootTransform(1.0f),
+    outdated(true),
+    culledCameraMatrix(1.0f),
+    culled(false) {
+
+    this->compile();
+}
+
+SceneGraph::SceneGraph(std::unique_ptr<Group> root) :
+    rootTransform(1.0f),
+    outdated(true),
+    culledCameraMatrix(1.0f),
+    culled(false) {
+
+    this->roots.push_back(std::move(root));
+    this->compile();
+}
+
+int SceneGraph::getEntityCount() const {
+    return this->entities.size();
+}
+
+void SceneGraph::update(const glm::mat4 &_rootTransform,
+                        float time,
+                        utils::JobSystem *jobSystem) {
+
+    this->culled = false;
+
+    // Everything moves with the root (e.g.: the player of a third person camera)
+    if (this->outdated || _rootTransform != this->rootTransform) {
+        this->rootTransform = _rootTransform;
+        this->updateAll(time, jobSystem);
+        this->outdated = false;
+        return;
+    }
+
+    // Animated groups inside the subtree of another one are updated along with it
+    this->updateSubtrees(this->animatedRoots, time, true, jobSystem);
+
+    for (uint32_t group : this->animatedRoots) {
+        // Ancestors that are already dirty had theirs marked too
+        for (uint32_t parent = this->parents[group];
+             parent != SceneGraph::noParent && !this->dirtyFlags[parent];
+             parent = this->parents[parent]) {
+
+            this->markDirty(parent);
+        }
+    }
+
+    // Children come after their parents, so their bounds are ready when going backwards
+    std::sort(this->dirtyGroups.begin(), this->dirtyGroups.end(), std::greater<>());
+    for (uint32_t group : this->dirtyGroups) {
+        this->updateGroupBoundingSphere(group);
+        this->dirtyFlags[group] = false;
+    }
+    this->dirtyGroups.clear();
+}
+
+void SceneGraph::drawSolidColorParts(render::RenderPipelineManager &pipelineManager,
+                                     const camera::Camera &camera,
+                                     bool showBoundingSpheres,
+                                     bool showAnimationLines,
+                                     bool showNormals) const {
+
+    if (!(showBoundingSpheres || showAnimationLines || showNormals)) {
+        return;
+    }
+
+    this->cull(camera);
+
+    const glm::mat4 &cameraMatrix = camera.getCameraMatrix();
+    for (uint32_t i = 0; i < this->parents.size();) {
+        if (showAnimationLines) {
+            this->transforms[i]->draw(pipelineManager, cameraMatrix * this->getParentMatrix(i));
+        }
+
+        if (!render::BoundingSphereArray::isVisible(this->groupVisibility, i)) {
+            i = this->subtreeEnds[i];
+            continue;
+        }
+
+        for (uint32_t j = this->firstEntities[i]; j < this->firstEntities[i + 1]; ++j) {
+            const render::BoundingSphere entityBoundingSphere = this->entityBoundingSpheres.get(j);
+
+            if (render::BoundingSphereArray::isVisible(this->entityVisibility, j)) {
+                if (showBoundingSpheres) {
+                    entityBoundingSphere.draw(pipelineManager,
+                                              cameraMatrix,
+                                              glm::vec4(1.0f, 0.0f, 0.0f, 1.0f));
+                }
+
+                if (showNormals) {
+                    this->entities[j]->getNormalsPreview().draw(
+                        pipelineManager,
+                        cameraMatrix * this->worldMatrices[i],
+                        glm::vec4(0.0f, 0.0f, 1.0f, 1.0f));
+                }
+            }
+        }
+
+        if (showBoundingSpheres) {
+            this->groupBoundingSpheres.get(i).draw(pipelineManager,
+                                               cameraMatrix,
+                                               glm::vec4(1.0f, 0.0f, 0.0f, 1.0f));
+        }
+
+        ++i;
+    }
+}
+
+void SceneGraph::addOccluders(render::OcclusionCuller &occlusionCuller,
+                              const camera::Camera &camera) const {
+
+    // Occluders outside of the frustum can't hide anything
+    this->cull(camera);
+    for (uint32_t i = 0; i < this->parents.size();) {
+        if (!render::BoundingSphereArray::isVisible(this->groupVisibility, i)) {
+            i = this->subtreeEnds[i];
+            continue;
+        }
+
+        const glm::mat4 fullMatrix = camera.getCameraMatrix() * this->worldMatrices[i];
+        for (uint32_t j = this->firstEntities[i]; j < this->firstEntities[i + 1]; ++j) {
+            if (render::BoundingSphereArray::isVisible(this->entityVisibility, j)) {
+                this->entities[j]->addOccluder(occlusionCuller, fullMatrix);
+            }
+        }
+
+        ++i;
+    }
+}
+
+int SceneGraph::drawShadedParts(render::RenderPipelineManager &pipelineManager,
+                                render::InstanceBatcher &instanceBatcher,
+                                render::OcclusionCuller &occlusionCuller,
+                                const camera::Camera &camera,
+                                bool fillPolygons) const {
+
+    this->cull(camera);
+
+    int renderedEntities = 0;
+    for (uint32_t i = 0; i < this->parents.size();) {
+        if (!render::BoundingSphereArray::isVisible(this->groupVisibility, i)) {
+            i = this->subtreeEnds[i];
+            continue;
+        } else if (occlusionCuller.isOccluded(this->groupBoundingSpheres.get(i))) {
+            occlusionCuller.countOccluded(this->firstEntities[this->subtreeEnds[i]] -
+                                          this->firstEntities[i]);
+            i = this->subtreeEnds[i];
+            continue;
+        }
+
+        const glm::mat4 &worldMatrix = this->worldMatrices[i];
+        const glm::mat4 fullMatrix = camera.getCameraMatrix() * worldMatrix;
+        const glm::mat4 normalMatrix = glm::inverse(glm::transpose(worldMatrix));
+
+        for (uint32_t j = this->firstEntities[i]; j < this->firstEntities[i + 1]; ++j) {
+            const render::BoundingSphere entityBoundingSphere = this->entityBoundingSpheres.get(j);
+
+            if (render::BoundingSphereArray::isVisible(this->entityVisibility, j)) {
+                if (occlusionCuller.isOccluded(entityBoundingSphere)) {
+                    occlusionCuller.countOccluded(1);
+                } else if (this->entities[j]->draw(pipelineManager,
+                                                   instanceBatcher,
+                                                   camera,
+                                                   entityBoundingSphere,
+                                                   fullMatrix,
+                                                   worldMatrix,
+                                                   normalMatrix,
+                                                   fillPolygons)) {
+                    renderedEntities++;
+                }
+            }
+        }
+
+        ++i;
+    }
+
+    return renderedEntities;
+}
+
+int SceneGraph::drawForPicking(render::RenderPipelineManager &pipelineManager,
+                               const camera::Camera &camera,
+                               std::unordered_map<int, std::string> &idToName,
+                               int currentId) const {
+
+    // Entity IDs follow the order of the arrays, so they don't depend on what's culled
+    this->cull(camera);
+    for (uint32_t i = 0; i < this->parents.size();) {
+        if (!render::BoundingSphereArray::isVisible(this->groupVisibility, i)) {
+            i = this->subtreeEnds[i];
+            continue;
+        }
+
+        const glm::mat4 fullMatrix = camera.getCameraMatrix() * this->worldMatrices[i];
+        for (uint32_t j = this->firstEntities[i]; j < this->firstEntities[i + 1]; ++j) {
+            const int id = currentId + j;
+
+            if (render::BoundingSphereArray::isVisible(this->entityVisibility, j)) {
+                const glm::vec4 idColor = glm::vec4 { (id & 0x000000FF) / 255.0f,
+                                                      ((id & 0x0000FF00) >> 8) / 255.0f,
+                                                      ((id & 0x00FF0000) >> 16) / 255.0f,
+                                                      1.0f };
+
+                this->entities[j]->drawSolidColor(pipelineManager, fullMatrix, idColor, true);
+            }
+
+            idToName[id] = this->entities[j]->getName();
+        }
+
+        ++i;
+    }
+
+    return currentId + this->entities.size();
+}
+
+void SceneGraph::compile() {
+    for (const std::unique_ptr<Group> &root : this->roots) {
+        this->addGroup(*root, SceneGraph::noParent);
+    }
+    this->firstEntities.push_back(this->entities.size());
+
+    this->worldMatrices.resize(this->parents.size(), glm::mat4(1.0f));
+    this->dirtyFlags.resize(this->parents.size(), false);
+
+    uint32_t animatedEnd = 0;
+    for (uint32_t i = 0; i < this->parents.size(); ++i) {
+        if (this->animated[i] && i >= animatedEnd) {
+            this->animatedRoots.push_back(i);
+            animatedEnd = this->subtreeEnds[i];
+        }
+    }
+
+    for (uint32_t i = 0; i < this->parents.size(); i = this->subtreeEnds[i]) {
+        this->splitIntoTasks(i);
+    }
+
+    this->groupBoundingSpheres.resize(this->parents.size());
+    this->entityBoundingSpheres.resize(this->entities.size());
+}
+
+void SceneGraph::addGroup(Group &group, uint32_t parent) {
+    const uint32_t index = this->parents.size();
+    this->parents.push_back(parent);
+    this->subtreeEnds.push_back(0);
+    this->firstEntities.push_back(this->entities.size());
+    this->transforms.push_back(&group.getTransform());
+    this->animated.push_back(group.getTransform().isAnimated());
+
+    for (const std::unique_ptr<Entity> &entity : group.getEntities()) {
+        this->entities.push_back(entity.get());
+        this->modelBoundingSpheres.push_back(entity->getModelBoundingSphere());
+    }
+
+    for (const std::unique_ptr<Group> &child : group.getGroups()) {
+        this->addGroup(*child, index);
+    }
+    this->subtreeEnds[index] = this->parents.size();
+}
+
+void SceneGraph::splitIntoTasks(uint32_t group) {
+    if (this->subtreeEnds[group] - group <= SceneGraph::maximumTaskGroups) {
+        this->taskRoots.push_back(group);
+        return;
+    }
+
+    this->taskAncestors.push_back(group);
+    for (uint32_t child = group + 1; child < this->subtreeEnds[group];
+         child = this->subtreeEnds[child]) {
+
+        this->splitIntoTasks(child);
+    }
+}
+
+void SceneGraph::updateAll(float time, utils::JobSystem *jobSystem) {
+    for (uint32_t group : this->taskAncestors) {
+        this->transforms[group]->update(time);
+        this->updateGroup(group);
+    }
+
+    this->updateSubtrees(this->taskRoots, time, false, jobSystem);
+
+    for (auto it = this->taskAncestors.crbegin(); it != this->taskAncestors.crend(); ++it) {
+        this->updateGroupBoundingSphere(*it);
+    }
+}
+
+void SceneGraph::updateSubtrees(const std::vector<uint32_t> &subtrees,
+                                float time,
+                                bool animatedOnly,
+                                utils::JobSystem *jobSystem) {
+
+    const auto updateRange = [this, &subtrees, time, animatedOnly](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; ++i) {
+            this->updateSubtree(subtrees[i], time, animatedOnly);
+        }
+    };
+
+    if (jobSystem) {
+        jobSystem->parallelFor(subtrees.size(), SceneGraph::subtreesPerJob, updateRange);
+    } else {
+        updateRange(0, subtrees.size());
+    }
+}
+
+void SceneGraph::updateSubtree(uint32_t group, float time, bool animatedOnly) {
+    const uint32_t end = this->subtreeEnds[group];
+    for (uint32_t i = group; i < end; ++i) {
+        if (this->animated[i] || !animatedOnly) {
+            this->transforms[i]->update(time);
+        }
+        this->updateGroup(i);
+    }
+
+    for (uint32_t i = end; i-- > group;) {
+        this->updateGroupBoundingSphere(i);
+    }
+}
+
+void SceneGraph::updateGroup(uint32_t group) {
+    this->worldMatrices[group] =
+        this->getParentMatrix(group) * this->transforms[group]->getMatrix();
+
+    for (uint32_t i = this->firstEntities[group]; i < this->firstEntities[group + 1]; ++i) {
+        this->entityBoundingSpheres.set(
+            i,
+            render::BoundingSphere(this->modelBoundingSpheres[i], this->worldMatrices[group]));
+    }
+}
+
+void SceneGraph::cull(const camera::Camera &camera) const {
+    // The scene is drawn more than once per frame (e.g.: solid colors, shaded parts, picking)
+    if (this->culled && camera.getCameraMatrix() == this->culledCameraMatrix) {
+        return;
+    }
+
+    camera.cullSpheres(this->groupBoundingSpheres, this->groupVisibility);
+    camera.cullSpheres(this->entityBoundingSpheres, this->entityVisibility);
+    this->culledCameraMatrix = camera.getCameraMatrix();
+    this->culled = true;
+}
+
+void SceneGraph::markDirty(uint32_t group) {
+    if (!this->dirtyFlags[group]) {
+        this->dirtyFlags[group] = true;
+        this->dirtyGroups.push_back(group);
+    }
+}
+
+void SceneGraph::updateGroupBoundingSphere(uint32_t group) {
+    // Center of the group's entities and direct subgroups (approximation for objects around the
+    // same size)
+    glm::vec4 center(0.0f);
+    int count = 0;
+
+    for (uint32_t j = this->firstEntities[group]; j < this->firstEntities[group + 1]; ++j) {
+        center += this->entityBoundingSpheres.get(j).getCenter();
+        count++;
+    }
+
+    for (uint32_t child = group + 1; child < this->subtreeEnds[group];
+         child = this->subtreeEnds[child]) {
+
+        center += this->groupBoundingSpheres.get(child).getCenter();
+        count++;
+    }
+
+    if (count == 0) {
+        this->groupBoundingSpheres.set(
+            group,
+            render::BoundingSphere(this->worldMatrices[group] * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f),
+                                   0.0f));
+        return;
+    }
+    center /= count;
+
+    // Radius of the sphere
+    float radius = 0.0f;
+    for (uint32_t j = this->firstEntities[group]; j < this->firstEntities[group + 1]; ++j) {
+        const render::BoundingSphere sphere = this->entityBoundingSpheres.get(j);
+        radius = std::max(radius, glm::distance(sphere.getCenter(), center) + sphere.getRadius());
+    }
+
+    for (uint32_t child = group + 1; child < this->subtreeEnds[group];
+         child = this->subtreeEnds[child]) {
+
+        const render::BoundingSphere sphere = this->groupBoundingSpheres.get(child);
+        radius = std::max(radius, glm::distance(sphere.getCenter(), center) + sphere.getRadius());
+    }
+
+    this->groupBoundingSpheres.set(group, render::BoundingSphere(center, radius));
+}
+
+const glm::mat4 &SceneGraph::getParentMatrix(uint32_t group) const {
+    const uint32_t parent = this->parents[group];
+    return parent == SceneGraph::noParent ? this->rootTransform : this->worldMatrices[parent];
+}
+
+}
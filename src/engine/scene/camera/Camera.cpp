@@ -12,11 +12,12 @@
 /// See the License for the specific language governing permissions and
 /// limitations under the License.
 
-#include <algorithm>
 #include <cmath>
 #include <glm/geometric.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <glm/matrix.hpp>
 #include <glm/vec4.hpp>
+#include <limits>
 
 #include "engine/scene/camera/Camera.hpp"
 
@@ -34,7 +35,10 @@ Camera::Camera(const glm::vec3 &_position,
     fov(_fov),
     near(_near),
     far(_far),
-    aspectRatio(1.0f) {
+    aspectRatio(1.0f),
+    windowHeight(1.0f),
+    lodTriangleSize(1.0f),
+    minimumProjectedSize(0.0f) {
 
     this->updateWithMotion();
 }
@@ -43,10 +47,34 @@ const glm::vec3 &Camera::getPosition() const {
     return this->position;
 }
 
+const glm::mat4 &Camera::getViewMatrix() const {
+    return this->viewMatrix;
+}
+
+const glm::mat4 &Camera::getProjectionMatrix() const {
+    return this->projectionMatrix;
+}
+
 const glm::mat4 &Camera::getCameraMatrix() const {
     return this->cameraMatrix;
 }
 
+float Camera::getNear() const {
+    return this->near;
+}
+
+float Camera::getFar() const {
+    return this->far;
+}
+
+float Camera::getLODTriangleSize() const {
+    return this->lodTriangleSize;
+}
+
+float Camera::getMinimumProjectedSize() const {
+    return this->minimumProjectedSize;
+}
+
 void Camera::setPosition(const glm::vec3 &pos) {
     this->position = pos;
     this->updateWithMotion();
@@ -54,9 +82,18 @@ void Camera::setPosition(const glm::vec3 &pos) {
 
 void Camera::setWindowSize(int width, int height) {
     this->aspectRatio = static_cast<float>(width) / height;
+    this->windowHeight = height;
     this->updateWithMotion();
 }
 
+void Camera::setLODTriangleSize(float size) {
+    this->lodTriangleSize = size;
+}
+
+void Camera::setMinimumProjectedSize(float size) {
+    this->minimumProjectedSize = size;
+}
+
 void Camera::move(const glm::vec3 &v) {
     static_cast<void>(v);
 }
@@ -89,9 +126,13 @@ void Camera::drawSolidColorParts(render::RenderPipelineManager &pipelineManager,
 }
 
 int Camera::drawShadedParts(render::RenderPipelineManager &pipelineManager,
+                            render::InstanceBatcher &instanceBatcher,
+                            render::OcclusionCuller &occlusionCuller,
                             bool fillPolygons) const {
 
     static_cast<void>(pipelineManager);
+    static_cast<void>(instanceBatcher);
+    static_cast<void>(occlusionCuller);
     static_cast<void>(fillPolygons);
     return 0;
 }
@@ -106,60 +147,40 @@ int Camera::drawForPicking(render::RenderPipelineManager &pipelineManager,
     return currentId;
 }
 
-bool Camera::isInFrustum(const render::BoundingSphere &sphere) const {
-    return std::none_of(this->viewFrustum.cbegin(),
-                        this->viewFrustum.cend(),
-                        [sphere](const glm::vec4 &plane) {
-                            const float distance =
-                                glm::dot(glm::vec3(plane), glm::vec3(sphere.getCenter())) + plane.w;
-                            return distance < -sphere.getRadius();
-                        });
+void Camera::cullSpheres(const render::BoundingSphereArray &spheres,
+                         std::vector<uint64_t> &visibility) const {
+
+    spheres.cull(this->viewFrustum, visibility);
+}
+
+float Camera::getProjectedSize(const render::BoundingSphere &sphere) const {
+    // Approximate diameter of the sphere on the screen, in pixels
+    const float distance = glm::distance(this->position, glm::vec3(sphere.getCenter()));
+    if (distance <= sphere.getRadius()) {
+        return std::numeric_limits<float>::infinity();
+    }
+
+    return sphere.getRadius() * this->windowHeight / (distance * tanf(this->fov / 2));
 }
 
 void Camera::updateWithMotion() {
     // Update camera matrix
-    const glm::mat4 view = glm::lookAt(this->position, this->lookAt, this->up);
-    const glm::mat4 projection =
+    this->viewMatrix = glm::lookAt(this->position, this->lookAt, this->up);
+    this->projectionMatrix =
         glm::perspective(this->fov, this->aspectRatio, this->near, this->far);
 
-    this->cameraMatrix = projection * view;
-
-    // Update view frustum
-    const float halfNearHeight = tanf(this->fov / 2) * this->near;
-    const float halfNearWidth = halfNearHeight * this->aspectRatio;
+    this->cameraMatrix = this->projectionMatrix * this->viewMatrix;
 
-    const float halfFarHeight = tanf(this->fov / 2) * this->far;
-    const float halfFarWidth = halfFarHeight * this->aspectRatio;
-
-    const glm::vec3 d = glm::normalize(this->lookAt - this->position);
-    const glm::vec3 right = glm::normalize(glm::cross(d, this->up));
-    const glm::vec3 realUp = glm::normalize(glm::cross(right, d));
-
-    const glm::vec3 farCenter = this->position + d * this->far;
-    const glm::vec3 nearCenter = this->position + d * this->near;
-
-    const glm::vec3 nearTopLeft = nearCenter + realUp * halfNearHeight - right * halfNearWidth;
-    const glm::vec3 nearTopRight = nearCenter + realUp * halfNearHeight + right * halfNearWidth;
-    const glm::vec3 nearBottomLeft = nearCenter - realUp * halfNearHeight - right * halfNearWidth;
-    const glm::vec3 nearBottomRight = nearCenter - realUp * halfNearHeight + right * halfNearWidth;
-
-    const glm::vec3 farTopLeft = farCenter + realUp * halfFarHeight - right * halfFarWidth;
-    const glm::vec3 farTopRight = farCenter + realUp * halfFarHeight + right * halfFarWidth;
-    const glm::vec3 farBottomLeft = farCenter - realUp * halfFarHeight - right * halfFarWidth;
-    const glm::vec3 farBottomRight = farCenter - realUp * halfFarHeight + right * halfFarWidth;
-
-    this->viewFrustum[0] = Camera::planeEquation(nearTopLeft, nearTopRight, nearBottomLeft);
-    this->viewFrustum[1] = Camera::planeEquation(farTopLeft, farBottomLeft, farTopRight);
-    this->viewFrustum[2] = Camera::planeEquation(nearTopLeft, nearBottomLeft, farTopLeft);
-    this->viewFrustum[3] = Camera::planeEquation(nearTopRight, farTopRight, nearBottomRight);
-    this->viewFrustum[4] = Camera::planeEquation(nearTopLeft, farTopLeft, nearTopRight);
-    this->viewFrustum[5] = Camera::planeEquation(farBottomRight, farBottomLeft, nearBottomLeft);
-}
+    // Update view frustum, with planes in world space (Gribb and Hartmann)
+    const glm::mat4 rows = glm::transpose(this->cameraMatrix);
+    for (int i = 0; i < 3; ++i) {
+        this->viewFrustum[2 * i + 0] = rows[3] + rows[i];
+        this->viewFrustum[2 * i + 1] = rows[3] - rows[i];
+    }
 
-glm::vec4 Camera::planeEquation(const glm::vec3 &p1, const glm::vec3 &p2, const glm::vec3 &p3) {
-    const glm::vec3 normal = glm::normalize(glm::cross(p2 - p1, p3 - p1));
-    const float constantFactor = glm::dot(-normal, p1);
-    return glm::vec4(normal, constantFactor);
+    for (glm::vec4 &plane : this->viewFrustum) {
+        plane /= glm::length(glm::vec3(plane));
+    }
 }
 
 }
@@ -27,8 +27,10 @@ namespace engine::scene::camera {
 std::unique_ptr<Camera> CameraFactory::createFromXML(
     const tinyxml2::XMLElement *cameraElement,
     const std::filesystem::path &sceneDirectory,
+    render::VertexFormat vertexFormat,
     std::unordered_map<std::string, std::shared_ptr<render::Model>> &loadedModels,
-    std::unordered_map<std::string, std::shared_ptr<render::Texture>> &loadedTextures) {
+    std::unordered_map<std::string, std::shared_ptr<render::Texture>> &loadedTextures,
+    std::vector<Material> &loadedMaterials) {
 
     // View matrix
     const glm::vec3 position =
@@ -58,25 +60,42 @@ std::unique_ptr<Camera> CameraFactory::createFromXML(
         cameraType = cameraTypePtr;
     }
 
+    std::unique_ptr<Camera> camera;
     if (cameraType == "orbital") {
-        return std::make_unique<camera::OrbitalCamera>(position, lookAt, up, fov, near, far);
+        camera = std::make_unique<OrbitalCamera>(position, lookAt, up, fov, near, far);
     } else if (cameraType == "free") {
-        return std::make_unique<camera::FreeCamera>(position, lookAt, up, fov, near, far);
+        camera = std::make_unique<FreeCamera>(position, lookAt, up, fov, near, far);
     } else if (cameraType == "thirdperson") {
         const tinyxml2::XMLElement *group = utils::XMLUtils::getSingleChild(cameraElement, "group");
         std::unique_ptr<scene::Group> player =
-            std::make_unique<scene::Group>(group, sceneDirectory, loadedModels, loadedTextures);
+            std::make_unique<scene::Group>(group,
+                                           sceneDirectory,
+                                           vertexFormat,
+                                           loadedModels,
+                                           loadedTextures,
+                                           loadedMaterials);
 
-        return std::make_unique<ThirdPersonCamera>(position,
-                                                   lookAt,
-                                                   up,
-                                                   fov,
-                                                   near,
-                                                   far,
-                                                   std::move(player));
+        camera = std::make_unique<ThirdPersonCamera>(position,
+                                                     lookAt,
+                                                     up,
+                                                     fov,
+                                                     near,
+                                                     far,
+                                                     std::move(player));
     } else {
         throw std::runtime_error("Invalid camera type in scene XML file");
     }
+
+    // Level of detail
+    const tinyxml2::XMLElement *lodElement = cameraElement->FirstChildElement("levelOfDetail");
+    if (lodElement) {
+        camera->setLODTriangleSize(
+            lodElement->FloatAttribute("triangleSize", camera->getLODTriangleSize()));
+        camera->setMinimumProjectedSize(
+            lodElement->FloatAttribute("minimumSize", camera->getMinimumProjectedSize()));
+    }
+
+    return camera;
 }
 
 }
@@ -46,12 +46,12 @@ void ThirdPersonCamera::move(const glm::vec3 &v) {
 }
 
 int ThirdPersonCamera::getEntityCount() const {
-    return this->player->getEntityCount();
+    return this->player.getEntityCount();
 }
 
 void ThirdPersonCamera::updateWithTime(float time) {
     OrbitalCamera::updateWithTime(time);
-    this->player->update(this->playerTransform, time);
+    this->player.update(this->playerTransform, time, nullptr);
 }
 
 void ThirdPersonCamera::drawSolidColorParts(render::RenderPipelineManager &pipelineManager,
@@ -59,32 +59,30 @@ void ThirdPersonCamera::drawSolidColorParts(render::RenderPipelineManager &pipel
                                             bool showAnimationLines,
                                             bool showNormals) const {
 
-    return this->player->drawSolidColorParts(pipelineManager,
-                                             *this,
-                                             this->playerTransform,
-                                             showBoundingSpheres,
-                                             showAnimationLines,
-                                             showNormals);
+    return this->player.drawSolidColorParts(pipelineManager,
+                                            *this,
+                                            showBoundingSpheres,
+                                            showAnimationLines,
+                                            showNormals);
 }
 
 int ThirdPersonCamera::drawShadedParts(render::RenderPipelineManager &pipelineManager,
+                                       render::InstanceBatcher &instanceBatcher,
+                                       render::OcclusionCuller &occlusionCuller,
                                        bool fillPolygons) const {
 
-    return this->player->drawShadedParts(pipelineManager,
-                                         *this,
-                                         this->playerTransform,
-                                         fillPolygons);
+    return this->player.drawShadedParts(pipelineManager,
+                                        instanceBatcher,
+                                        occlusionCuller,
+                                        *this,
+                                        fillPolygons);
 }
 
 int ThirdPersonCamera::drawForPicking(render::RenderPipelineManager &pipelineManager,
                                       std::unordered_map<int, std::string> &idToName,
                                       int currentId) const {
 
-    return this->player->drawForPicking(pipelineManager,
-                                        *this,
-                                        this->playerTransform,
-                                        idToName,
-                                        currentId);
+    return this->player.drawForPicking(pipelineManager, *this, idToName, currentId);
 }
 
 void ThirdPersonCamera::updateWithMotion() {
@@ -20,5 +20,11 @@
 #include "engine/scene/light/Light.hpp"
 
 namespace engine::scene::light {
-Light::Light() {}
+
+Light::Light(Type _type) : type(_type) {}
+
+Light::Type Light::getType() const {
+    return this->type;
+}
+
 }
@@ -14,6 +14,8 @@
 
 #include <glm/trigonometric.hpp>
 #include <glm/vec3.hpp>
+#include <limits>
+#include <stdexcept>
 
 #include "engine/scene/light/DirectionalLight.hpp"
 #include "engine/scene/light/LightFactory.hpp"
@@ -30,20 +32,27 @@ std::unique_ptr<Light> LightFactory::createFromXML(const tinyxml2::XMLElement *l
         lightType = lightTypePtr;
     }
 
+    // Point lights and spotlights fade out up to their range, and reach everything by default
+    const float range =
+        lightElement->FloatAttribute("range", std::numeric_limits<float>::infinity());
+    if (!(range > 0.0f)) {
+        throw std::runtime_error("Invalid light range in scene XML file");
+    }
+
     if (lightType == "directional") {
         const glm::vec3 direction = utils::XMLUtils::getLightDirection(lightElement);
         return std::make_unique<light::DirectionalLight>(direction);
 
     } else if (lightType == "point") {
         const glm::vec3 position = utils::XMLUtils::getLightPosition(lightElement);
-        return std::make_unique<light::PointLight>(position);
+        return std::make_unique<light::PointLight>(position, range);
 
     } else if (lightType == "spotlight") {
         const glm::vec3 position = utils::XMLUtils::getLightPosition(lightElement);
         const glm::vec3 direction = utils::XMLUtils::getLightDirection(lightElement);
         const float cutoff = glm::radians(lightElement->FloatAttribute("cutoff", 10.0f));
 
-        return std::make_unique<light::Spotlight>(position, direction, cutoff);
+        return std::make_unique<light::Spotlight>(position, direction, cutoff, range);
     } else {
         throw std::runtime_error("Invalid light type in scene XML file");
     }
@@ -16,10 +16,17 @@
 
 namespace engine::scene::light {
 
-PointLight::PointLight(const glm::vec3 &_position) : position(_position) {}
+PointLight::PointLight(const glm::vec3 &_position, float _range) :
+    Light(Type::Point),
+    position(_position),
+    range(_range) {}
 
 const glm::vec3 &PointLight::getPosition() const {
     return this->position;
 }
 
+float PointLight::getRange() const {
+    return this->range;
+}
+
 }
@@ -17,8 +17,15 @@
 
 namespace engine::scene::light {
 
-Spotlight::Spotlight(const glm::vec3 &_position, const glm::vec3 &_direction, float _cutoff) :
-    position(_position), direction(glm::normalize(_direction)), cutoff(_cutoff) {}
+Spotlight::Spotlight(const glm::vec3 &_position,
+                     const glm::vec3 &_direction,
+                     float _cutoff,
+                     float _range) :
+    Light(Type::Spot),
+    position(_position),
+    direction(glm::normalize(_direction)),
+    cutoff(_cutoff),
+    range(_range) {}
 
 const glm::vec3 &Spotlight::getPosition() const {
     return this->position;
@@ -32,4 +39,8 @@ float Spotlight::getCutoff() const {
     return this->cutoff;
 }
 
+float Spotlight::getRange() const {
+    return this->range;
+}
+
 }
@@ -40,4 +40,8 @@ void AnimatedRotation::update(float time) {
     this->matrix = glm::rotate(this->rotationAngle, this->rotationAxis);
 }
 
+bool AnimatedRotation::isAnimated() const {
+    return true;
+}
+
 }
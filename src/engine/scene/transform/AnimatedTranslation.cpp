@@ -85,6 +85,10 @@ void AnimatedTranslation::update(float time) {
     }
 }
 
+bool AnimatedTranslation::isAnimated() const {
+    return true;
+}
+
 void AnimatedTranslation::draw(render::RenderPipelineManager &pipelineManager,
                                const glm::mat4 &transformMatrix) const {
 
@@ -27,6 +27,10 @@ const glm::mat4 &BaseTransform::getMatrix() const {
     return this->matrix;
 }
 
+bool BaseTransform::isAnimated() const {
+    return false;
+}
+
 void BaseTransform::draw(render::RenderPipelineManager &pipelineManager,
                          const glm::mat4 &transformMatrix) const {
 
@@ -12,6 +12,7 @@
 /// See the License for the specific language governing permissions and
 /// limitations under the License.
 
+#include <algorithm>
 #include <GLFW/glfw3.h>
 #include <stdexcept>
 
@@ -80,6 +81,14 @@ void TRSTransform::update(float time) {
         this->transforms[2]->getMatrix();
 }
 
+bool TRSTransform::isAnimated() const {
+    return std::any_of(this->transforms.cbegin(),
+                       this->transforms.cend(),
+                       [](const std::unique_ptr<BaseTransform> &transform) {
+                           return transform->isAnimated();
+                       });
+}
+
 void TRSTransform::draw(render::RenderPipelineManager &pipelineManager,
                         const glm::mat4 &transformMatrix) const {
 
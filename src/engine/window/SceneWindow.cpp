@@ -14,31 +14,37 @@
 
 #include <array>
 #include <cstdint>
+#include <iostream>
 
 #include "engine/render/Framebuffer.hpp"
 #include "engine/window/SceneWindow.hpp"
 
 namespace engine::window {
 
-SceneWindow::SceneWindow(const std::string &sceneFile) :
+SceneWindow::SceneWindow(const std::string &sceneFile,
+                         render::InstanceBatcher::DepthPrepass depthPrepass,
+                         bool _timeFirstFrame) :
     Window(sceneFile + " (press U to toggle UI)", 640, 480),
+    jobSystem(),
     scene(sceneFile),
-    pipelineManager(scene.getPointLightCount(),
-                    scene.getDirectionalLightCount(),
-                    scene.getSpotlightCount()),
+    pipelineManager(scene.getMaterials()),
+    instanceBatcher(),
+    occlusionCuller(jobSystem),
     cameraController(scene.getCamera()),
-    ui(*this, scene.getCamera(), scene.getEntityCount()),
+    ui(*this, scene.getCamera(), instanceBatcher, scene.getEntityCount()),
     selectedEntity(),
-    showUI(true) {
+    showUI(true),
+    timeFirstFrame(_timeFirstFrame) {
 
     glEnable(GL_DEPTH_TEST);
+    this->instanceBatcher.setDepthPrepass(depthPrepass);
     this->resize(scene.getWindowWidth(), scene.getWindowHeight());
 }
 
 void SceneWindow::onUpdate(float time, float timeElapsed) {
     static_cast<void>(timeElapsed);
     this->cameraController.onUpdate(time);
-    this->scene.update(time);
+    this->scene.update(time, this->jobSystem);
 }
 
 void SceneWindow::onRender() {
@@ -46,15 +52,28 @@ void SceneWindow::onRender() {
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
 
     const int renderedEntities = this->scene.draw(this->pipelineManager,
+                                                  this->instanceBatcher,
+                                                  this->occlusionCuller,
                                                   this->ui.shouldFillPolygons(),
                                                   this->ui.shouldCullBackFaces(),
                                                   this->ui.shouldShowAxes(),
                                                   this->ui.shouldShowBoundingSpheres(),
                                                   this->ui.shouldShowAnimationLines(),
-                                                  this->ui.shouldShowNormals());
+                                                  this->ui.shouldShowNormals(),
+                                                  this->ui.shouldCullOccluded());
 
     if (this->showUI) {
-        this->ui.draw(renderedEntities, selectedEntity);
+        this->ui.draw(renderedEntities,
+                      this->occlusionCuller.getOccludedEntities(),
+                      selectedEntity);
+    }
+
+    // Startup time, mostly spent loading models and compiling shaders, for comparing cold and warm
+    // shader caches. GLFW's timer starts before the scene is loaded.
+    if (this->timeFirstFrame) {
+        glFinish();
+        std::cout << "Time to first frame: " << glfwGetTime() * 1000.0 << " ms" << std::endl;
+        this->timeFirstFrame = false;
     }
 }
 
@@ -20,8 +20,12 @@
 
 namespace engine::window {
 
-UI::UI(const Window &window, scene::camera::Camera &_camera, int _entityCount) :
+UI::UI(const Window &window,
+       scene::camera::Camera &_camera,
+       render::InstanceBatcher &_instanceBatcher,
+       int _entityCount) :
     camera(_camera),
+    instanceBatcher(_instanceBatcher),
     fpsCounter(),
     entityCount(_entityCount),
     fillPolygons(true),
@@ -29,7 +33,8 @@ UI::UI(const Window &window, scene::camera::Camera &_camera, int _entityCount) :
     showAxes(true),
     showBoundingSpheres(false),
     showAnimationLines(true),
-    showNormals(false) {
+    showNormals(false),
+    occlusionCulling(true) {
 
     IMGUI_CHECKVERSION();
     ImGui::CreateContext();
@@ -50,7 +55,7 @@ bool UI::isCapturingKeyboard() const {
     return io.WantCaptureKeyboard || io.WantTextInput;
 }
 
-void UI::draw(int renderedEntities, const std::string &selectedEntity) {
+void UI::draw(int renderedEntities, int occludedEntities, const std::string &selectedEntity) {
     ImGui_ImplOpenGL3_NewFrame();
     ImGui_ImplGlfw_NewFrame();
     ImGui::NewFrame();
@@ -61,7 +66,8 @@ void UI::draw(int renderedEntities, const std::string &selectedEntity) {
     ImGui::Text("FPS: %d", this->fpsCounter.getFPS());
 
     const std::string entityText = std::to_string(renderedEntities) + " / " +
-        std::to_string(this->entityCount) + " entities rendered";
+        std::to_string(this->entityCount) + " entities rendered (" +
+        std::to_string(occludedEntities) + " occluded)";
     ImGui::Text(entityText.c_str());
 
     if (selectedEntity != "") {
@@ -80,6 +86,28 @@ void UI::draw(int renderedEntities, const std::string &selectedEntity) {
     ImGui::Checkbox("Show Bounding Spheres", &this->showBoundingSpheres);
     ImGui::Checkbox("Show Animation Lines", &this->showAnimationLines);
     ImGui::Checkbox("Show Normals", &this->showNormals);
+    ImGui::Checkbox("Occlusion Culling", &this->occlusionCulling);
+
+    float lodTriangleSize = this->camera.getLODTriangleSize();
+    if (ImGui::SliderFloat("LOD Triangle Size", &lodTriangleSize, 0.5f, 32.0f, "%.1f px")) {
+        this->camera.setLODTriangleSize(lodTriangleSize);
+    }
+
+    float minimumProjectedSize = this->camera.getMinimumProjectedSize();
+    if (ImGui::SliderFloat("Minimum Entity Size", &minimumProjectedSize, 0.0f, 32.0f, "%.1f px")) {
+        this->camera.setMinimumProjectedSize(minimumProjectedSize);
+    }
+
+    const char *const depthPrepassModes[] = { "Off", "On", "Automatic" };
+    int depthPrepass = static_cast<int>(this->instanceBatcher.getDepthPrepass());
+    if (ImGui::Combo("Depth Pre-pass", &depthPrepass, depthPrepassModes, 3)) {
+        this->instanceBatcher.setDepthPrepass(
+            static_cast<render::InstanceBatcher::DepthPrepass>(depthPrepass));
+    }
+
+    ImGui::Text("Overdraw: %.2f (pre-pass %s)",
+                this->instanceBatcher.getOverdraw(),
+                this->instanceBatcher.isUsingDepthPrepass() ? "on" : "off");
 
     ImGui::Spacing();
     ImGui::Separator();
@@ -121,4 +149,8 @@ bool UI::shouldShowNormals() const {
     return this->showNormals;
 }
 
+bool UI::shouldCullOccluded() const {
+    return this->occlusionCulling;
+}
+
 }
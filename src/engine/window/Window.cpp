@@ -15,6 +15,7 @@
 #include <glad/glad.h>
 #include <stdexcept>
 
+#include "engine/render/GeometryArena.hpp"
 #include "engine/window/Window.hpp"
 
 namespace engine {
@@ -77,6 +78,9 @@ Window::Window(const std::string &title, int _width, int _height) : width(_width
 }
 
 Window::~Window() {
+    // Subclasses, and with them every model, have already been destroyed
+    render::GeometryArena::destroyAll();
+
     glfwDestroyWindow(this->handle);
     glfwTerminate();
 }
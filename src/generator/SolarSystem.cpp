@@ -34,7 +34,7 @@ SolarSystem::SolarSystem(float sunScale, float rockyScale, float gasScale, float
     this->createObjects(sunScale, rockyScale, gasScale);
 }
 
-void SolarSystem::writeToFile(const std::string &dirname) {
+void SolarSystem::writeToFile(const std::string &dirname, int precision) {
     std::filesystem::create_directory(dirname);
     const std::filesystem::path directoryPath = dirname;
 
@@ -45,13 +45,13 @@ void SolarSystem::writeToFile(const std::string &dirname) {
     }
 
     figures::Sphere sphere(1.0f, 32, 32);
-    sphere.writeToFile(directoryPath / "sphere.3d");
+    sphere.writeToFile(directoryPath / "sphere.3d", precision);
 
     figures::Torus torus(1.0f, 0.2f, 32, 8);
-    torus.writeToFile(directoryPath / "torus.3d");
+    torus.writeToFile(directoryPath / "torus.3d", precision);
 
     BezierPatch bezierPatch("res/patches/comet.patch", 10);
-    bezierPatch.writeToFile(directoryPath / "comet.3d");
+    bezierPatch.writeToFile(directoryPath / "comet.3d", precision);
 
     std::filesystem::directory_iterator end;
     for (std::filesystem::directory_iterator it("res/textures/solarSystem"); it != end; ++it) {
@@ -105,6 +105,11 @@ tinyxml2::XMLElement *SolarSystem::createBody(const std::string &name,
 
         tinyxml2::XMLElement *texture = model->InsertNewChildElement("texture");
         texture->SetAttribute("file", (name + ".jpg").c_str());
+
+        // The Sun and the planets are large enough to hide other bodies
+        if (name != "Moon") {
+            model->SetAttribute("occluder", true);
+        }
     }
 
     if (name == "Sun") {
@@ -15,7 +15,9 @@
 #include <cmath>
 #include <iomanip>
 #include <iostream>
+#include <limits>
 #include <numeric>
+#include <sstream>
 
 #include "generator/BezierPatch.hpp"
 #include "generator/figures/Box.hpp"
@@ -28,6 +30,8 @@
 #include "generator/figures/Sphere.hpp"
 #include "generator/figures/Torus.hpp"
 #include "generator/SolarSystem.hpp"
+#include "utils/MeshOptimizer.hpp"
+#include "utils/MeshSimplifier.hpp"
 #include "utils/WavefrontOBJ.hpp"
 
 namespace generator {
@@ -58,6 +62,12 @@ size_t getLengthOfUsageColumn(size_t column) {
 void printUsage(const std::string &programName) {
     std::cerr << "Wrong usage. Here's the correct one:" << std::endl << std::endl;
 
+    std::cerr << "Every command may be preceded by --precision <digits> (significant digits in "
+                 "written models, 6 by default, capped at "
+              << std::numeric_limits<float>::max_digits10 << ")"
+              << std::endl
+              << std::endl;
+
     std::cerr << "Figure generation:" << std::endl;
     std::cerr << std::left;
     for (const std::vector<std::string> &usage : FIGURE_USAGES) {
@@ -78,6 +88,9 @@ void printUsage(const std::string &programName) {
 
     std::cerr << std::endl << "Model conversion:" << std::endl;
     std::cerr << "  " << programName << " patch <patchFile> <tessellation> <file>" << std::endl;
+    std::cerr << "  " << programName << " optimize <modelFile> <file>" << std::endl;
+    std::cerr << "  " << programName
+              << " lod <modelFile> <percentages (e.g.: 50,25,10,2)> <filePrefix>" << std::endl;
 }
 
 float stringToFloat(const std::string &str) {
@@ -104,9 +117,19 @@ void validateArgumentCount(int providedArgs, int expectedArgs) {
 }
 
 int main(int argc, char **argv) {
-    const std::vector<std::string> args(argv, argv + argc);
+    std::vector<std::string> args(argv, argv + argc);
 
     try {
+        int precision = 6;
+        if (args.size() > 2 && args[1] == "--precision") {
+            precision = stringToInt(args[2]);
+            if (precision < 1) {
+                throw std::invalid_argument("Precision below 1");
+            }
+            args.erase(args.begin() + 1, args.begin() + 3);
+            argc = args.size();
+        }
+
         const std::string &file = args.at(args.size() - 1);
 
         if (args.at(1) == "plane") {
@@ -115,17 +138,17 @@ int main(int argc, char **argv) {
             const int divisions = stringToInt(args.at(3));
 
             figures::Plane plane(length, divisions);
-            plane.writeToFile(file);
+            plane.writeToFile(file, precision);
         } else if (args.at(1) == "box") {
             const float length = stringToFloat(args.at(2));
             const int grid = stringToInt(args.at(3));
 
             if (argc == 5) {
                 figures::Box box(length, grid);
-                box.writeToFile(file);
+                box.writeToFile(file, precision);
             } else if (argc == 6 && args.at(4) == "multi-textured") {
                 figures::Box box(length, grid, true);
-                box.writeToFile(file);
+                box.writeToFile(file, precision);
             } else {
                 throw std::invalid_argument("Invalid command-line arguments");
             }
@@ -137,7 +160,7 @@ int main(int argc, char **argv) {
             const int stacks = stringToInt(args.at(4));
 
             figures::Sphere sphere(radius, slices, stacks);
-            sphere.writeToFile(file);
+            sphere.writeToFile(file, precision);
         } else if (args.at(1) == "cone") {
             validateArgumentCount(argc, 7);
             float radius = stringToFloat(args.at(2));
@@ -146,7 +169,7 @@ int main(int argc, char **argv) {
             int stacks = stringToInt(args.at(5));
 
             figures::Cone cone(radius, height, slices, stacks);
-            cone.writeToFile(file);
+            cone.writeToFile(file, precision);
         } else if (args.at(1) == "cylinder") {
             float radius = stringToFloat(args.at(2));
             float height = stringToFloat(args.at(3));
@@ -155,10 +178,10 @@ int main(int argc, char **argv) {
 
             if (argc == 7) {
                 figures::Cylinder cylinder(radius, height, slices, stacks);
-                cylinder.writeToFile(file);
+                cylinder.writeToFile(file, precision);
             } else if (argc == 8 && args.at(6) == "multi-textured") {
                 figures::Cylinder cylinder(radius, height, slices, stacks, true);
-                cylinder.writeToFile(file);
+                cylinder.writeToFile(file, precision);
             } else {
                 throw std::invalid_argument("Invalid command-line arguments");
             }
@@ -171,7 +194,7 @@ int main(int argc, char **argv) {
             int stacks = stringToInt(args.at(5));
 
             figures::Torus torus(majorRadius, minorRadius, slices, stacks);
-            torus.writeToFile(file);
+            torus.writeToFile(file, precision);
         } else if (args.at(1) == "mobiusStrip") {
             validateArgumentCount(argc, 8);
 
@@ -182,7 +205,7 @@ int main(int argc, char **argv) {
             const int stacks = stringToInt(args.at(6));
 
             figures::MobiusStrip mobius(radius, width, twist, slices, stacks);
-            mobius.writeToFile(file);
+            mobius.writeToFile(file, precision);
         } else if (args.at(1) == "kleinBottle") {
             validateArgumentCount(argc, 6);
             float radius = stringToFloat(args.at(2));
@@ -190,7 +213,7 @@ int main(int argc, char **argv) {
             int stacks = stringToInt(args.at(4));
 
             figures::KleinBottle kleinbottle(radius, slices, stacks);
-            kleinbottle.writeToFile(file);
+            kleinbottle.writeToFile(file, precision);
         } else if (args.at(1) == "gear") {
             validateArgumentCount(argc, 9);
 
@@ -202,11 +225,11 @@ int main(int argc, char **argv) {
             const int stacks = stringToInt(args.at(7));
 
             figures::Gear gear(majorRadius, minorRadius, toothHeight, height, teeth, stacks);
-            gear.writeToFile(file);
+            gear.writeToFile(file, precision);
         } else if (args.at(1) == "solarSystem") {
             if (argc == 3) {
                 SolarSystem solarSystem;
-                solarSystem.writeToFile(file);
+                solarSystem.writeToFile(file, precision);
             } else if (argc == 7) {
                 const float sunScale = stringToFloat(args.at(2));
                 const float rockyScale = stringToFloat(args.at(3));
@@ -214,7 +237,7 @@ int main(int argc, char **argv) {
                 const float timeScale = stringToFloat(args.at(5));
 
                 SolarSystem solarSystem(sunScale, rockyScale, gasScale, timeScale);
-                solarSystem.writeToFile(file);
+                solarSystem.writeToFile(file, precision);
             } else {
                 throw std::invalid_argument("Wrong number of command-line arguments");
             }
@@ -224,7 +247,51 @@ int main(int argc, char **argv) {
             const int tessellation = stringToInt(args.at(3));
 
             BezierPatch patch(patchFile, tessellation);
-            patch.writeToFile(file);
+            patch.writeToFile(file, precision);
+        } else if (args.at(1) == "optimize") {
+            validateArgumentCount(argc, 4);
+            const utils::WavefrontOBJ object(args.at(2));
+            auto [positions, textureCoordinates, normals, indices] = object.getIndexedVertices();
+            const size_t vertexCount = positions.size();
+
+            std::cout << "Before: ACMR = " << utils::MeshOptimizer::getACMR(indices, vertexCount)
+                      << ", ATVR = " << utils::MeshOptimizer::getATVR(indices, vertexCount)
+                      << std::endl;
+
+            utils::MeshOptimizer::optimize(positions, textureCoordinates, normals, indices);
+
+            std::cout << "After:  ACMR = " << utils::MeshOptimizer::getACMR(indices, vertexCount)
+                      << ", ATVR = " << utils::MeshOptimizer::getATVR(indices, vertexCount)
+                      << std::endl;
+
+            const utils::WavefrontOBJ optimized(positions, textureCoordinates, normals, indices);
+            optimized.writeToFile(file, precision);
+        } else if (args.at(1) == "lod") {
+            validateArgumentCount(argc, 5);
+            const utils::WavefrontOBJ object(args.at(2));
+            auto [positions, textureCoordinates, normals, indices] = object.getIndexedVertices();
+            const size_t triangleCount = indices.size() / 3;
+
+            // Each level is simplified from the previous one
+            std::stringstream percentages(args.at(3));
+            std::string percentageString;
+            while (std::getline(percentages, percentageString, ',')) {
+                const int percentage = stringToInt(percentageString);
+                if (percentage <= 0 || percentage > 100) {
+                    throw std::invalid_argument("Percentage out of range");
+                }
+
+                indices = utils::MeshSimplifier::simplify(positions,
+                                                          indices,
+                                                          triangleCount * percentage / 100);
+                utils::MeshOptimizer::optimize(positions, textureCoordinates, normals, indices);
+
+                std::cout << percentage << "%: " << indices.size() / 3 << " / " << triangleCount
+                          << " triangles" << std::endl;
+
+                const utils::WavefrontOBJ level(positions, textureCoordinates, normals, indices);
+                level.writeToFile(file + "_" + percentageString + ".3d", precision);
+            }
         } else {
             printUsage(args[0]);
             return 1;
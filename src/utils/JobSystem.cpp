@@ -0,0 +1,185 @@
+/// Copyright 2025 Ana Oliveira, Humberto Gomes, Mariana Rocha, Sara Lopes
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+
+#include "utils/JobSystem.hpp"
+
+namespace utils {
+
+JobSystem::WorkQueue::WorkQueue() : top(0), bottom(0) {
+    for (std::atomic<uint64_t> &range : this->ranges) {
+        range.store(0, std::memory_order_relaxed);
+    }
+}
+
+bool JobSystem::WorkQueue::push(uint64_t range) {
+    const int64_t b = this->bottom.load(std::memory_order_relaxed);
+    const int64_t t = this->top.load(std::memory_order_acquire);
+    if (b - t >= WorkQueue::capacity) {
+        return false;
+    }
+
+    this->ranges[b % WorkQueue::capacity].store(range, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    this->bottom.store(b + 1, std::memory_order_relaxed);
+    return true;
+}
+
+bool JobSystem::WorkQueue::pop(uint64_t &range) {
+    const int64_t b = this->bottom.load(std::memory_order_relaxed) - 1;
+    this->bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = this->top.load(std::memory_order_relaxed);
+
+    if (t > b) {
+        this->bottom.store(b + 1, std::memory_order_relaxed);
+        return false;
+    }
+
+    range = this->ranges[b % WorkQueue::capacity].load(std::memory_order_relaxed);
+    if (t == b) {
+        // Last range in the deque, which a thief may be taking too
+        const bool taken = this->top.compare_exchange_strong(t,
+                                                             t + 1,
+                                                             std::memory_order_seq_cst,
+                                                             std::memory_order_relaxed);
+        this->bottom.store(b + 1, std::memory_order_relaxed);
+        return taken;
+    }
+
+    return true;
+}
+
+bool JobSystem::WorkQueue::steal(uint64_t &range) {
+    int64_t t = this->top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const int64_t b = this->bottom.load(std::memory_order_acquire);
+
+    if (t >= b) {
+        return false;
+    }
+
+    range = this->ranges[t % WorkQueue::capacity].load(std::memory_order_relaxed);
+    return this->top.compare_exchange_strong(t,
+                                             t + 1,
+                                             std::memory_order_seq_cst,
+                                             std::memory_order_relaxed);
+}
+
+JobSystem::JobSystem() : function(nullptr), grainSize(1), remaining(0), epoch(0), stopping(false) {
+    const unsigned int threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+    for (unsigned int i = 0; i < threadCount; ++i) {
+        this->queues.push_back(std::make_unique<WorkQueue>());
+    }
+
+    for (unsigned int i = 1; i < threadCount; ++i) {
+        this->workers.emplace_back(&JobSystem::work, this, i);
+    }
+}
+
+JobSystem::~JobSystem() {
+    this->stopping.store(true, std::memory_order_release);
+    this->wake();
+
+    for (std::thread &worker : this->workers) {
+        worker.join();
+    }
+}
+
+void JobSystem::parallelFor(uint32_t count, uint32_t _grainSize, const RangeFunction &_function) {
+    if (count == 0) {
+        return;
+    } else if (this->workers.empty() || count <= _grainSize) {
+        _function(0, count);
+        return;
+    }
+
+    this->function.store(&_function, std::memory_order_relaxed);
+    this->grainSize.store(std::max(_grainSize, 1u), std::memory_order_relaxed);
+    this->remaining.store(count, std::memory_order_relaxed);
+
+    // Pushing publishes the loop to the threads that steal from this deque
+    this->queues[0]->push(static_cast<uint64_t>(0) << 32 | count);
+    this->wake();
+
+    while (this->remaining.load(std::memory_order_acquire) != 0) {
+        uint64_t range;
+        if (this->findWork(0, range)) {
+            this->execute(0, range);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+int JobSystem::getThreadCount() const {
+    return this->queues.size();
+}
+
+void JobSystem::work(int index) {
+    while (true) {
+        // Read before looking for work, so that work pushed in the meantime isn't slept through
+        const uint32_t currentEpoch = this->epoch.load(std::memory_order_acquire);
+        if (this->stopping.load(std::memory_order_acquire)) {
+            return;
+        }
+
+        uint64_t range;
+        if (this->findWork(index, range)) {
+            this->execute(index, range);
+        } else {
+            this->epoch.wait(currentEpoch, std::memory_order_acquire);
+        }
+    }
+}
+
+bool JobSystem::findWork(int index, uint64_t &range) {
+    if (this->queues[index]->pop(range)) {
+        return true;
+    }
+
+    for (size_t i = 1; i < this->queues.size(); ++i) {
+        if (this->queues[(index + i) % this->queues.size()]->steal(range)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void JobSystem::execute(int index, uint64_t range) {
+    uint32_t begin = range >> 32;
+    uint32_t end = range & 0xffffffff;
+
+    // Keep the lower half, and leave the upper one for other threads
+    const uint32_t grain = this->grainSize.load(std::memory_order_relaxed);
+    while (end - begin > grain) {
+        const uint32_t middle = begin + (end - begin) / 2;
+        if (!this->queues[index]->push(static_cast<uint64_t>(middle) << 32 | end)) {
+            break;
+        }
+
+        this->wake();
+        end = middle;
+    }
+
+    (*this->function.load(std::memory_order_relaxed))(begin, end);
+    this->remaining.fetch_sub(end - begin, std::memory_order_acq_rel);
+}
+
+void JobSystem::wake() {
+    this->epoch.fetch_add(1, std::memory_order_release);
+    this->epoch.notify_all();
+}
+
+}
@@ -0,0 +1,71 @@
+/// Copyright 2025 Ana Oliveira, Humberto Gomes, Mariana Rocha, Sara Lopes
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "utils/MappedFile.hpp"
+
+namespace utils {
+
+MappedFile::MappedFile(const std::string &filename) : data(nullptr), size(0), open(false) {
+    const int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return;
+    }
+
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) < 0 || !S_ISREG(fileStat.st_mode)) {
+        close(fd);
+        return;
+    }
+
+    // mmap() doesn't allow empty mappings, but an empty file is still a valid file
+    this->size = fileStat.st_size;
+    if (this->size > 0) {
+        void *const mapping = mmap(nullptr, this->size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED) {
+            close(fd);
+            return;
+        }
+
+        madvise(mapping, this->size, MADV_SEQUENTIAL);
+        this->data = mapping;
+    }
+
+    close(fd);
+    this->open = true;
+}
+
+MappedFile::~MappedFile() {
+    if (this->data) {
+        munmap(this->data, this->size);
+    }
+}
+
+bool MappedFile::isOpen() const {
+    return this->open;
+}
+
+const char *MappedFile::getData() const {
+    return static_cast<const char *>(this->data);
+}
+
+size_t MappedFile::getSize() const {
+    return this->size;
+}
+
+}
@@ -0,0 +1,409 @@
+/// Copyright 2025 Ana Oliveira, Humberto Gomes, Mariana Rocha, Sara Lopes
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+
+#include <algorithm>
+#include <glm/geometric.hpp>
+#include <limits>
+#include <numeric>
+#include <type_traits>
+#include <utility>
+
+#include "utils/MeshOptimizer.hpp"
+
+namespace utils {
+
+void MeshOptimizer::optimize(std::vector<glm::vec4> &positions,
+                             std::vector<glm::vec2> &textureCoordinates,
+                             std::vector<glm::vec4> &normals,
+                             std::vector<uint32_t> &indices) {
+
+    if (indices.empty()) {
+        return;
+    }
+
+    // Small meshes may already be in a better order than the one found
+    std::vector<uint32_t> reordered =
+        MeshOptimizer::reorderForVertexCache(indices, positions.size());
+
+    if (MeshOptimizer::getACMR(reordered, positions.size()) <
+        MeshOptimizer::getACMR(indices, positions.size())) {
+
+        indices = std::move(reordered);
+    }
+
+    indices = MeshOptimizer::buildClusters(positions, indices);
+    indices = MeshOptimizer::reorderForOverdraw(positions, indices);
+    MeshOptimizer::reorderForVertexFetch(positions, textureCoordinates, normals, indices);
+}
+
+float MeshOptimizer::getACMR(const std::vector<uint32_t> &indices, size_t vertexCount) {
+    if (indices.empty()) {
+        return 0.0f;
+    }
+
+    return static_cast<float>(MeshOptimizer::countCacheMisses(indices, vertexCount)) /
+        (indices.size() / 3);
+}
+
+float MeshOptimizer::getATVR(const std::vector<uint32_t> &indices, size_t vertexCount) {
+    if (vertexCount == 0) {
+        return 0.0f;
+    }
+
+    return static_cast<float>(MeshOptimizer::countCacheMisses(indices, vertexCount)) / vertexCount;
+}
+
+std::vector<uint32_t> MeshOptimizer::reorderForVertexCache(const std::vector<uint32_t> &indices,
+                                                           size_t vertexCount) {
+
+    // Tipsify (Sander et al., "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw")
+    const size_t triangleCount = indices.size() / 3;
+
+    std::vector<uint32_t> adjacencyOffsets, adjacency;
+    MeshOptimizer::getTriangleAdjacency(indices, vertexCount, adjacencyOffsets, adjacency);
+
+    std::vector<uint32_t> liveTriangles(vertexCount);
+    for (size_t i = 0; i < vertexCount; ++i) {
+        liveTriangles[i] = adjacencyOffsets[i + 1] - adjacencyOffsets[i];
+    }
+
+    std::vector<uint32_t> cacheTimes(vertexCount, 0);
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<uint32_t> deadEnds, candidates, output;
+    output.reserve(indices.size());
+
+    uint32_t time = MeshOptimizer::cacheSize + 1;
+    size_t cursor = 1;
+    int64_t vertex = 0;
+
+    while (vertex >= 0) {
+        // Emit all triangles around the current vertex
+        candidates.clear();
+        for (uint32_t i = adjacencyOffsets[vertex]; i < adjacencyOffsets[vertex + 1]; ++i) {
+            const uint32_t triangle = adjacency[i];
+            if (emitted[triangle]) {
+                continue;
+            }
+
+            for (int j = 0; j < 3; ++j) {
+                const uint32_t v = indices[triangle * 3 + j];
+                output.push_back(v);
+                deadEnds.push_back(v);
+                candidates.push_back(v);
+                liveTriangles[v]--;
+
+                if (time - cacheTimes[v] > MeshOptimizer::cacheSize) {
+                    cacheTimes[v] = time++;
+                }
+            }
+
+            emitted[triangle] = true;
+        }
+
+        // Prefer the oldest cached vertex that won't leave the cache before its triangles are drawn
+        vertex = -1;
+        int64_t bestPriority = -1;
+        for (uint32_t candidate : candidates) {
+            if (liveTriangles[candidate] > 0) {
+                int64_t priority = 0;
+                if (time - cacheTimes[candidate] + 2 * liveTriangles[candidate] <=
+                    MeshOptimizer::cacheSize) {
+
+                    priority = time - cacheTimes[candidate];
+                }
+
+                if (priority > bestPriority) {
+                    bestPriority = priority;
+                    vertex = candidate;
+                }
+            }
+        }
+
+        // Dead end: go back to a recently used vertex, or to any vertex with triangles left
+        if (vertex == -1) {
+            while (!deadEnds.empty() && vertex == -1) {
+                const uint32_t candidate = deadEnds.back();
+                deadEnds.pop_back();
+
+                if (liveTriangles[candidate] > 0) {
+                    vertex = candidate;
+                }
+            }
+
+            while (cursor < vertexCount && vertex == -1) {
+                if (liveTriangles[cursor] > 0) {
+                    vertex = cursor;
+                }
+                cursor++;
+            }
+        }
+    }
+
+    return output;
+}
+
+std::vector<uint32_t> MeshOptimizer::buildClusters(const std::vector<glm::vec4> &positions,
+                                                   const std::vector<uint32_t> &indices) {
+
+    const size_t triangleCount = indices.size() / 3;
+
+    std::vector<uint32_t> adjacencyOffsets, adjacency;
+    MeshOptimizer::getTriangleAdjacency(indices, positions.size(), adjacencyOffsets, adjacency);
+
+    std::vector<glm::vec3> centroids(triangleCount), normals(triangleCount);
+    for (size_t triangle = 0; triangle < triangleCount; ++triangle) {
+        const glm::vec3 p0 = glm::vec3(positions[indices[triangle * 3 + 0]]);
+        const glm::vec3 p1 = glm::vec3(positions[indices[triangle * 3 + 1]]);
+        const glm::vec3 p2 = glm::vec3(positions[indices[triangle * 3 + 2]]);
+
+        const glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+        const float length = glm::length(normal);
+
+        centroids[triangle] = (p0 + p1 + p2) / 3.0f;
+        normals[triangle] = length > 0.0f ? normal / length : glm::vec3(0.0f);
+    }
+
+    const uint32_t unassigned = std::numeric_limits<uint32_t>::max();
+    std::vector<uint32_t> clusterOf(triangleCount, unassigned);
+    std::vector<uint32_t> candidateOf(triangleCount, unassigned);
+    std::vector<uint32_t> localVertices(positions.size(), unassigned);
+    std::vector<uint32_t> cluster, candidates, clusterIndices, clusterVertices, output;
+    output.reserve(indices.size());
+
+    size_t cursor = 0;
+    for (uint32_t clusterIndex = 0; output.size() < indices.size(); ++clusterIndex) {
+        cluster.clear();
+        candidates.clear();
+        clusterVertices.clear();
+        glm::vec3 centroidSum = glm::vec3(0.0f), normalSum = glm::vec3(0.0f);
+
+        while (cluster.size() < MeshOptimizer::clusterSize &&
+               output.size() / 3 + cluster.size() < triangleCount) {
+
+            // Prefer adjacent triangles that add the fewest vertices, so that no small gaps are
+            // left behind. Among those, grow towards the closest one, penalizing those facing
+            // elsewhere, so that both the bounding sphere and the normal cone stay small.
+            const glm::vec3 center = centroidSum / static_cast<float>(cluster.size());
+            const float normalLength = glm::length(normalSum);
+            const glm::vec3 axis = normalLength > 0.0f ? normalSum / normalLength : glm::vec3(0.0f);
+
+            int64_t best = -1;
+            int bestNewVertices = 4;
+            float bestCost = std::numeric_limits<float>::infinity();
+            for (size_t i = 0; i < candidates.size();) {
+                const uint32_t candidate = candidates[i];
+                if (clusterOf[candidate] != unassigned) {
+                    candidates[i] = candidates.back();
+                    candidates.pop_back();
+                    continue;
+                }
+
+                int newVertices = 0;
+                for (int j = 0; j < 3; ++j) {
+                    newVertices += localVertices[indices[candidate * 3 + j]] == unassigned;
+                }
+
+                const float cost = glm::distance(centroids[candidate], center) *
+                    (2.0f - glm::dot(normals[candidate], axis));
+                if (newVertices < bestNewVertices ||
+                    (newVertices == bestNewVertices && cost < bestCost)) {
+
+                    bestNewVertices = newVertices;
+                    bestCost = cost;
+                    best = candidate;
+                }
+                ++i;
+            }
+
+            // No adjacent triangles left: continue from the next one in vertex cache order
+            if (best == -1) {
+                while (clusterOf[cursor] != unassigned) {
+                    cursor++;
+                }
+                best = cursor;
+            }
+
+            clusterOf[best] = clusterIndex;
+            cluster.push_back(best);
+            centroidSum += centroids[best];
+            normalSum += normals[best];
+
+            for (int j = 0; j < 3; ++j) {
+                const uint32_t v = indices[best * 3 + j];
+                if (localVertices[v] == unassigned) {
+                    localVertices[v] = clusterVertices.size();
+                    clusterVertices.push_back(v);
+                }
+
+                for (uint32_t k = adjacencyOffsets[v]; k < adjacencyOffsets[v + 1]; ++k) {
+                    const uint32_t triangle = adjacency[k];
+                    if (clusterOf[triangle] == unassigned &&
+                        candidateOf[triangle] != clusterIndex) {
+
+                        candidateOf[triangle] = clusterIndex;
+                        candidates.push_back(triangle);
+                    }
+                }
+            }
+        }
+
+        // Reorder each cluster for the vertex cache on its own
+        clusterIndices.clear();
+        for (uint32_t triangle : cluster) {
+            for (int j = 0; j < 3; ++j) {
+                clusterIndices.push_back(localVertices[indices[triangle * 3 + j]]);
+            }
+        }
+
+        for (uint32_t index :
+             MeshOptimizer::reorderForVertexCache(clusterIndices, clusterVertices.size())) {
+            output.push_back(clusterVertices[index]);
+        }
+
+        for (uint32_t v : clusterVertices) {
+            localVertices[v] = unassigned;
+        }
+    }
+
+    return output;
+}
+
+std::vector<uint32_t> MeshOptimizer::reorderForOverdraw(const std::vector<glm::vec4> &positions,
+                                                        const std::vector<uint32_t> &indices) {
+
+    const size_t triangleCount = indices.size() / 3;
+    const size_t clusterCount =
+        (triangleCount + MeshOptimizer::clusterSize - 1) / MeshOptimizer::clusterSize;
+
+    // Draw clusters facing away from the center of the mesh first, as they're more likely to
+    // occlude others
+    const glm::vec3 meshCenter =
+        glm::vec3(std::reduce(positions.cbegin(), positions.cend(), glm::vec4(0.0f))) /
+        static_cast<float>(positions.size());
+
+    std::vector<float> sortKeys(clusterCount);
+    for (size_t i = 0; i < clusterCount; ++i) {
+        const size_t start = i * MeshOptimizer::clusterSize;
+        const size_t end = std::min<size_t>(start + MeshOptimizer::clusterSize, triangleCount);
+
+        glm::vec3 center = glm::vec3(0.0f), normal = glm::vec3(0.0f);
+        float area = 0.0f;
+
+        for (size_t triangle = start; triangle < end; ++triangle) {
+            const glm::vec3 p0 = glm::vec3(positions[indices[triangle * 3 + 0]]);
+            const glm::vec3 p1 = glm::vec3(positions[indices[triangle * 3 + 1]]);
+            const glm::vec3 p2 = glm::vec3(positions[indices[triangle * 3 + 2]]);
+
+            const glm::vec3 triangleNormal = glm::cross(p1 - p0, p2 - p0);
+            const float triangleArea = glm::length(triangleNormal);
+
+            center += (p0 + p1 + p2) * (triangleArea / 3.0f);
+            normal += triangleNormal;
+            area += triangleArea;
+        }
+
+        const float normalLength = glm::length(normal);
+        if (area > 0.0f && normalLength > 0.0f) {
+            sortKeys[i] = glm::dot(center / area - meshCenter, normal / normalLength);
+        } else {
+            sortKeys[i] = 0.0f;
+        }
+    }
+
+    // Only the last cluster may be smaller, and it must stay last for the others to be aligned
+    std::vector<size_t> clusterOrder(clusterCount);
+    std::iota(clusterOrder.begin(), clusterOrder.end(), 0);
+    std::stable_sort(clusterOrder.begin(),
+                     clusterOrder.end() - (triangleCount % MeshOptimizer::clusterSize != 0),
+                     [&sortKeys](size_t a, size_t b) { return sortKeys[a] > sortKeys[b]; });
+
+    std::vector<uint32_t> output;
+    output.reserve(indices.size());
+    for (size_t cluster : clusterOrder) {
+        const size_t start = cluster * MeshOptimizer::clusterSize;
+        const size_t end = std::min<size_t>(start + MeshOptimizer::clusterSize, triangleCount);
+        output.insert(output.end(), indices.cbegin() + start * 3, indices.cbegin() + end * 3);
+    }
+
+    return output;
+}
+
+void MeshOptimizer::reorderForVertexFetch(std::vector<glm::vec4> &positions,
+                                          std::vector<glm::vec2> &textureCoordinates,
+                                          std::vector<glm::vec4> &normals,
+                                          std::vector<uint32_t> &indices) {
+
+    // Number vertices in order of first use, so that vertex fetches are mostly sequential
+    const uint32_t unused = std::numeric_limits<uint32_t>::max();
+    std::vector<uint32_t> remap(positions.size(), unused);
+    uint32_t vertexCount = 0;
+
+    for (uint32_t &index : indices) {
+        if (remap[index] == unused) {
+            remap[index] = vertexCount++;
+        }
+        index = remap[index];
+    }
+
+    const auto remapAttribute = [&remap, vertexCount, unused](auto &attribute) {
+        std::remove_reference_t<decltype(attribute)> remapped(vertexCount);
+        for (size_t i = 0; i < attribute.size(); ++i) {
+            if (remap[i] != unused) {
+                remapped[remap[i]] = attribute[i];
+            }
+        }
+        attribute = std::move(remapped);
+    };
+
+    remapAttribute(positions);
+    remapAttribute(textureCoordinates);
+    remapAttribute(normals);
+}
+
+void MeshOptimizer::getTriangleAdjacency(const std::vector<uint32_t> &indices,
+                                         size_t vertexCount,
+                                         std::vector<uint32_t> &adjacencyOffsets,
+                                         std::vector<uint32_t> &adjacency) {
+
+    // Triangles adjacent to each vertex
+    adjacencyOffsets.assign(vertexCount + 1, 0);
+    for (uint32_t index : indices) {
+        adjacencyOffsets[index + 1]++;
+    }
+    std::partial_sum(adjacencyOffsets.cbegin(), adjacencyOffsets.cend(), adjacencyOffsets.begin());
+
+    adjacency.resize(indices.size());
+    std::vector<uint32_t> adjacencyEnds(adjacencyOffsets.cbegin(), adjacencyOffsets.cend() - 1);
+    for (size_t i = 0; i < indices.size(); ++i) {
+        adjacency[adjacencyEnds[indices[i]]++] = i / 3;
+    }
+}
+
+size_t MeshOptimizer::countCacheMisses(std::span<const uint32_t> indices, size_t vertexCount) {
+    // FIFO cache, where a vertex leaves the cache after cacheSize other misses
+    std::vector<uint32_t> cacheTimes(vertexCount, 0);
+    uint32_t time = MeshOptimizer::cacheSize + 1;
+    size_t misses = 0;
+
+    for (uint32_t index : indices) {
+        if (time - cacheTimes[index] > MeshOptimizer::cacheSize) {
+            cacheTimes[index] = time++;
+            misses++;
+        }
+    }
+
+    return misses;
+}
+
+}
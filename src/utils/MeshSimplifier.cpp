@@ -0,0 +1,339 @@
+/// Copyright 2025 Ana Oliveira, Humberto Gomes, Mariana Rocha, Sara Lopes
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+
+#include <algorithm>
+#include <glm/geometric.hpp>
+#include <numeric>
+#include <queue>
+#include <tuple>
+
+#include "utils/MeshSimplifier.hpp"
+
+namespace utils {
+
+std::vector<uint32_t> MeshSimplifier::simplify(const std::vector<glm::vec4> &positions,
+                                               const std::vector<uint32_t> &indices,
+                                               size_t targetTriangleCount) {
+
+    // Garland and Heckbert, "Surface Simplification Using Quadric Error Metrics", with vertices
+    // collapsing onto one of their neighbors, so that no new vertex attributes are needed
+    const size_t vertexCount = positions.size();
+    const size_t triangleCount = indices.size() / 3;
+    if (targetTriangleCount >= triangleCount) {
+        return indices;
+    }
+
+    // Vertices sharing their position with others (attribute seams) are never removed, as their
+    // attributes can't be moved along with them
+    const std::vector<uint32_t> positionIds = MeshSimplifier::weldPositions(positions);
+    std::vector<uint32_t> positionUses(vertexCount, 0);
+    for (uint32_t positionId : positionIds) {
+        positionUses[positionId]++;
+    }
+
+    std::vector<uint32_t> triangles = indices;
+    std::vector<bool> deadTriangles(triangleCount, false);
+    std::vector<std::vector<uint32_t>> vertexTriangles(vertexCount);
+    std::vector<Quadric> quadrics(vertexCount, Quadric { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 });
+    size_t liveTriangles = triangleCount;
+
+    const auto getPosition = [&positions](uint32_t vertex) {
+        return glm::vec3(positions[vertex]);
+    };
+
+    // Initial quadrics, weighted by triangle area
+    for (size_t triangle = 0; triangle < triangleCount; ++triangle) {
+        const uint32_t *vertices = &triangles[triangle * 3];
+        if (vertices[0] == vertices[1] || vertices[1] == vertices[2] ||
+            vertices[0] == vertices[2]) {
+
+            deadTriangles[triangle] = true;
+            liveTriangles--;
+            continue;
+        }
+
+        const glm::vec3 p0 = getPosition(vertices[0]);
+        const glm::vec3 normal = glm::cross(getPosition(vertices[1]) - p0,
+                                            getPosition(vertices[2]) - p0);
+        const float doubleArea = glm::length(normal);
+
+        for (int i = 0; i < 3; ++i) {
+            vertexTriangles[vertices[i]].push_back(triangle);
+            if (doubleArea > 0.0f) {
+                const glm::vec3 unitNormal = normal / doubleArea;
+                MeshSimplifier::addPlane(quadrics[vertices[i]],
+                                         unitNormal,
+                                         -glm::dot(unitNormal, p0),
+                                         doubleArea / 2.0f);
+            }
+        }
+    }
+
+    // Keep open borders in place with planes perpendicular to them
+    const std::vector<uint64_t> edges = MeshSimplifier::getEdges(triangles, positionIds);
+    for (size_t triangle = 0; triangle < triangleCount; ++triangle) {
+        if (deadTriangles[triangle]) {
+            continue;
+        }
+
+        const uint32_t *vertices = &triangles[triangle * 3];
+        const glm::vec3 normal = glm::cross(getPosition(vertices[1]) - getPosition(vertices[0]),
+                                            getPosition(vertices[2]) - getPosition(vertices[0]));
+
+        for (int i = 0; i < 3; ++i) {
+            const uint32_t a = vertices[i], b = vertices[(i + 1) % 3];
+            const uint64_t key = MeshSimplifier::getEdgeKey(positionIds[a], positionIds[b]);
+
+            const auto edge = std::lower_bound(edges.cbegin(), edges.cend(), key);
+            if (edge + 1 != edges.cend() && *(edge + 1) == key) {
+                continue; // Not a border
+            }
+
+            const glm::vec3 direction = getPosition(b) - getPosition(a);
+            const glm::vec3 borderNormal = glm::cross(direction, normal);
+            const float borderNormalLength = glm::length(borderNormal);
+            if (borderNormalLength > 0.0f) {
+                const glm::vec3 unitNormal = borderNormal / borderNormalLength;
+                const float distance = -glm::dot(unitNormal, getPosition(a));
+                const float weight =
+                    MeshSimplifier::boundaryWeight * glm::dot(direction, direction);
+
+                MeshSimplifier::addPlane(quadrics[a], unitNormal, distance, weight);
+                MeshSimplifier::addPlane(quadrics[b], unitNormal, distance, weight);
+            }
+        }
+    }
+
+    // Collapses are validated when they leave the queue. Those involving vertices that changed
+    // since being queued are outdated, as a newer one was queued when the change happened.
+    std::vector<uint32_t> versions(vertexCount, 0);
+    std::vector<bool> removed(vertexCount, false);
+
+    const auto compareCollapses = [](const Collapse &a, const Collapse &b) {
+        return a.cost > b.cost;
+    };
+    std::priority_queue<Collapse, std::vector<Collapse>, decltype(compareCollapses)> queue(
+        compareCollapses);
+
+    const auto getCost = [&quadrics, &getPosition](uint32_t from, uint32_t to) {
+        Quadric quadric = quadrics[from];
+        MeshSimplifier::addQuadric(quadric, quadrics[to]);
+        return std::max(MeshSimplifier::evaluateQuadric(quadric, getPosition(to)), 0.0);
+    };
+
+    const auto queueEdge = [&](uint32_t a, uint32_t b) {
+        const bool aRemovable = positionUses[positionIds[a]] == 1;
+        const bool bRemovable = positionUses[positionIds[b]] == 1;
+
+        const double abCost = aRemovable ? getCost(a, b) : 0.0;
+        const double baCost = bRemovable ? getCost(b, a) : 0.0;
+
+        if (aRemovable && (!bRemovable || abCost <= baCost)) {
+            queue.push(Collapse { abCost, a, b, versions[a], versions[b] });
+        } else if (bRemovable) {
+            queue.push(Collapse { baCost, b, a, versions[b], versions[a] });
+        }
+    };
+
+    for (size_t triangle = 0; triangle < triangleCount; ++triangle) {
+        if (!deadTriangles[triangle]) {
+            for (int i = 0; i < 3; ++i) {
+                queueEdge(triangles[triangle * 3 + i], triangles[triangle * 3 + (i + 1) % 3]);
+            }
+        }
+    }
+
+    const auto canCollapse = [&](uint32_t from, uint32_t to) {
+        const glm::vec3 destination = getPosition(to);
+        bool adjacent = false;
+
+        for (uint32_t triangle : vertexTriangles[from]) {
+            if (deadTriangles[triangle]) {
+                continue;
+            }
+
+            uint32_t *vertices = &triangles[triangle * 3];
+            if (vertices[0] == to || vertices[1] == to || vertices[2] == to) {
+                adjacent = true;
+                continue; // This triangle will be removed
+            }
+
+            // Another vertex in the same position as the destination can't be merged with it
+            glm::vec3 before[3], after[3];
+            for (int i = 0; i < 3; ++i) {
+                if (positionIds[vertices[i]] == positionIds[to]) {
+                    return false;
+                }
+
+                before[i] = getPosition(vertices[i]);
+                after[i] = vertices[i] == from ? destination : before[i];
+            }
+
+            // Don't let triangles flip over
+            const glm::vec3 normalBefore = glm::cross(before[1] - before[0], before[2] - before[0]);
+            const glm::vec3 normalAfter = glm::cross(after[1] - after[0], after[2] - after[0]);
+            if (glm::dot(normalBefore, normalAfter) < MeshSimplifier::minimumNormalCosine *
+                    glm::length(normalBefore) * glm::length(normalAfter)) {
+                return false;
+            }
+        }
+
+        return adjacent;
+    };
+
+    while (liveTriangles > targetTriangleCount && !queue.empty()) {
+        const Collapse collapse = queue.top();
+        queue.pop();
+
+        const uint32_t from = collapse.from, to = collapse.to;
+        if (removed[from] || removed[to] || versions[from] != collapse.fromVersion ||
+            versions[to] != collapse.toVersion || !canCollapse(from, to)) {
+            continue;
+        }
+
+        // Move all triangles from the removed vertex to its destination
+        for (uint32_t triangle : vertexTriangles[from]) {
+            if (deadTriangles[triangle]) {
+                continue;
+            }
+
+            uint32_t *vertices = &triangles[triangle * 3];
+            if (vertices[0] == to || vertices[1] == to || vertices[2] == to) {
+                deadTriangles[triangle] = true;
+                liveTriangles--;
+            } else {
+                std::replace(vertices, vertices + 3, from, to);
+                vertexTriangles[to].push_back(triangle);
+            }
+        }
+
+        removed[from] = true;
+        vertexTriangles[from].clear();
+        MeshSimplifier::addQuadric(quadrics[to], quadrics[from]);
+        versions[to]++;
+
+        std::erase_if(vertexTriangles[to],
+                      [&deadTriangles](uint32_t triangle) { return deadTriangles[triangle]; });
+
+        for (uint32_t triangle : vertexTriangles[to]) {
+            for (int i = 0; i < 3; ++i) {
+                const uint32_t neighbor = triangles[triangle * 3 + i];
+                if (neighbor != to) {
+                    queueEdge(to, neighbor);
+                }
+            }
+        }
+    }
+
+    std::vector<uint32_t> output;
+    output.reserve(liveTriangles * 3);
+    for (size_t triangle = 0; triangle < triangleCount; ++triangle) {
+        if (!deadTriangles[triangle]) {
+            output.insert(output.end(),
+                          triangles.cbegin() + triangle * 3,
+                          triangles.cbegin() + triangle * 3 + 3);
+        }
+    }
+
+    return output;
+}
+
+std::vector<uint32_t> MeshSimplifier::weldPositions(const std::vector<glm::vec4> &positions) {
+    // Vertices in the same position are given the index of one of them
+    std::vector<uint32_t> order(positions.size());
+    std::iota(order.begin(), order.end(), 0);
+
+    const auto lessThan = [&positions](uint32_t a, uint32_t b) {
+        const glm::vec4 &pa = positions[a], &pb = positions[b];
+        return std::tie(pa.x, pa.y, pa.z, pa.w) < std::tie(pb.x, pb.y, pb.z, pb.w);
+    };
+    std::sort(order.begin(), order.end(), lessThan);
+
+    std::vector<uint32_t> positionIds(positions.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        if (i > 0 && !lessThan(order[i - 1], order[i])) {
+            positionIds[order[i]] = positionIds[order[i - 1]];
+        } else {
+            positionIds[order[i]] = order[i];
+        }
+    }
+
+    return positionIds;
+}
+
+std::vector<uint64_t> MeshSimplifier::getEdges(const std::vector<uint32_t> &indices,
+                                               const std::vector<uint32_t> &positionIds) {
+
+    // Sorted edges between positions, repeated once for every triangle they belong to
+    std::vector<uint64_t> edges;
+    edges.reserve(indices.size());
+
+    for (size_t i = 0; i < indices.size(); i += 3) {
+        for (int j = 0; j < 3; ++j) {
+            const uint32_t a = positionIds[indices[i + j]];
+            const uint32_t b = positionIds[indices[i + (j + 1) % 3]];
+            if (a != b) {
+                edges.push_back(MeshSimplifier::getEdgeKey(a, b));
+            }
+        }
+    }
+
+    std::sort(edges.begin(), edges.end());
+    return edges;
+}
+
+uint64_t MeshSimplifier::getEdgeKey(uint32_t a, uint32_t b) {
+    return static_cast<uint64_t>(std::min(a, b)) << 32 | std::max(a, b);
+}
+
+void MeshSimplifier::addPlane(Quadric &quadric,
+                              const glm::vec3 &normal,
+                              float distance,
+                              float weight) {
+
+    const double a = normal.x, b = normal.y, c = normal.z, d = distance;
+    quadric.a2 += weight * a * a;
+    quadric.ab += weight * a * b;
+    quadric.ac += weight * a * c;
+    quadric.ad += weight * a * d;
+    quadric.b2 += weight * b * b;
+    quadric.bc += weight * b * c;
+    quadric.bd += weight * b * d;
+    quadric.c2 += weight * c * c;
+    quadric.cd += weight * c * d;
+    quadric.d2 += weight * d * d;
+}
+
+void MeshSimplifier::addQuadric(Quadric &quadric, const Quadric &other) {
+    quadric.a2 += other.a2;
+    quadric.ab += other.ab;
+    quadric.ac += other.ac;
+    quadric.ad += other.ad;
+    quadric.b2 += other.b2;
+    quadric.bc += other.bc;
+    quadric.bd += other.bd;
+    quadric.c2 += other.c2;
+    quadric.cd += other.cd;
+    quadric.d2 += other.d2;
+}
+
+double MeshSimplifier::evaluateQuadric(const Quadric &quadric, const glm::vec3 &point) {
+    // v^T Q v, for v = (x, y, z, 1)
+    const double x = point.x, y = point.y, z = point.z;
+    return quadric.a2 * x * x + 2 * quadric.ab * x * y + 2 * quadric.ac * x * z +
+        2 * quadric.ad * x + quadric.b2 * y * y + 2 * quadric.bc * y * z + 2 * quadric.bd * y +
+        quadric.c2 * z * z + 2 * quadric.cd * z + quadric.d2;
+}
+
+}
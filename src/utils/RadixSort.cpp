@@ -0,0 +1,52 @@
+/// Copyright 2025 Ana Oliveira, Humberto Gomes, Mariana Rocha, Sara Lopes
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+
+#include <array>
+#include <cstddef>
+
+#include "utils/RadixSort.hpp"
+
+namespace utils {
+
+void RadixSort::sort(std::vector<uint64_t> &keys, std::vector<uint64_t> &scratch) {
+    // Build the histograms of all digits in a single read of the keys
+    std::array<std::array<size_t, 256>, 8> histograms {};
+    for (uint64_t key : keys) {
+        for (int digit = 0; digit < 8; ++digit) {
+            histograms[digit][(key >> (digit * 8)) & 0xff]++;
+        }
+    }
+
+    scratch.resize(keys.size());
+    for (int digit = 0; digit < 8; ++digit) {
+        std::array<size_t, 256> &histogram = histograms[digit];
+        if (keys.empty() || histogram[(keys[0] >> (digit * 8)) & 0xff] == keys.size()) {
+            continue;
+        }
+
+        size_t offset = 0;
+        for (size_t &count : histogram) {
+            const size_t bucketSize = count;
+            count = offset;
+            offset += bucketSize;
+        }
+
+        for (uint64_t key : keys) {
+            scratch[histogram[(key >> (digit * 8)) & 0xff]++] = key;
+        }
+        keys.swap(scratch);
+    }
+}
+
+}
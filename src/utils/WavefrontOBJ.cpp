@@ -12,307 +12,665 @@
 /// See the License for the specific language governing permissions and
 /// limitations under the License.
 
-#define GLM_ENABLE_EXPERIMENTAL
 #include <algorithm>
+#include <bit>
+#include <charconv>
 #include <cstdlib>
+#include <cstring>
+#include <deque>
 #include <fstream>
-#include <glm/gtx/hash.hpp>
-#include <optional>
-#include <unordered_map>
+#include <functional>
+#include <future>
+#include <glm/geometric.hpp>
+#include <limits>
+#include <stdexcept>
+#include <thread>
 #include <utility>
 
+#include "utils/MappedFile.hpp"
 #include "utils/WavefrontOBJ.hpp"
 
-namespace std {
-template<>
-struct hash<tuple<glm::vec4, glm::vec2, glm::vec3>> {
-    size_t operator()(const tuple<glm::vec4, glm::vec2, glm::vec3> &t) const {
-        const size_t h1 = hash<glm::vec4>()(get<0>(t));
-        const size_t h2 = hash<glm::vec2>()(get<1>(t));
-        const size_t h3 = hash<glm::vec3>()(get<2>(t));
-        return h1 ^ (h2 << 1) ^ (h3 << 2);
-    }
-};
-}
-
 namespace utils {
 
 WavefrontOBJ::WavefrontOBJ() {}
 
 WavefrontOBJ::WavefrontOBJ(const std::string &filename) {
-    std::ifstream file;
-    file.open(filename);
-    if (!file.is_open()) {
+    const MappedFile file(filename);
+    if (!file.isOpen()) {
         throw std::ios_base::failure("Failed to open OBJ file: " + filename);
     }
 
-    std::string line;
-    std::optional<bool> completeFaces;
-    int lineNumber = 1;
-    while (std::getline(file, line)) {
-        std::smatch match;
-        if (std::regex_match(line, match, WavefrontOBJ::lineRegex)) {
-            if (match.str(1).length() > 0) {
-                const float x = std::stof(match.str(1));
-                const float y = std::stof(match.str(2));
-                const float z = std::stof(match.str(3));
-
-                std::string wString = match.str(4);
-                float w = 1.0f;
-                if (wString.length() > 0) {
-                    w = std::stof(wString);
-                }
+    // Large files are split at line boundaries and parsed in parallel
+    const size_t parallelThreshold = 16 * 1024 * 1024;
+    const unsigned int threads = std::thread::hardware_concurrency();
+    const char *const begin = file.getData();
+    const char *const end = begin + file.getSize();
 
-                this->positions.push_back(glm::vec4(x, y, z, w));
-            } else if (match.str(5).length() > 0) {
-                const float u = std::stof(match.str(5));
-                const float v = std::stof(match.str(6));
+    const ParseStatistics statistics = file.getSize() >= parallelThreshold && threads > 1
+        ? this->parseLinesInParallel(begin, end, threads)
+        : this->parseLines(begin, end);
 
-                this->textureCoordinates.push_back(glm::vec2(u, v));
-            } else if (match.str(7).length() > 0) {
-                const float x = std::stof(match.str(7));
-                const float y = std::stof(match.str(8));
-                const float z = std::stof(match.str(9));
+    if (statistics.failed) {
+        throw std::runtime_error("Failed to parse OBJ file " + filename + ": line " +
+                                 std::to_string(statistics.lineCount + 1));
+    }
 
-                if (completeFaces.value_or(false)) {
-                    throw std::runtime_error("Can't mix face types in OBJ file: " + filename);
-                }
+    // Faces without normals get generated ones, indexed by position, so they can't coexist with
+    // normals in the file
+    if (statistics.hasNormals && statistics.hasSimpleFaces) {
+        throw std::runtime_error("Can't mix face types in OBJ file: " + filename);
+    }
 
-                this->normals.push_back(glm::vec3(x, y, z));
-                completeFaces = std::make_optional<bool>(false);
-            } else if (match.str(10).length() > 0) {
-                const int p1 = std::stoi(match.str(10)) - 1;
-                const int p2 = std::stoi(match.str(11)) - 1;
-                const int p3 = std::stoi(match.str(12)) - 1;
+    // Vertices may be declared after the faces that use them, so indices can only be checked now
+    if (statistics.maxPosition >= static_cast<int32_t>(this->positions.size())) {
+        throw std::runtime_error("Invalid position indices in OBJ file: " + filename);
+    }
 
-                if (!completeFaces.value_or(true)) {
-                    throw std::runtime_error("Can't mix face types in OBJ file: " + filename);
-                }
+    if (statistics.maxTextureCoordinate >= static_cast<int32_t>(this->textureCoordinates.size())) {
+        throw std::runtime_error("Invalid texture coordinate indices in OBJ file: " + filename);
+    }
+
+    if (statistics.maxNormal >= static_cast<int32_t>(this->normals.size())) {
+        throw std::runtime_error("Invalid normal indices in OBJ file: " + filename);
+    }
+
+    if (statistics.hasSimpleFaces) {
+        this->generateNormals();
+    }
+}
+
+WavefrontOBJ::WavefrontOBJ(const std::vector<glm::vec4> &_positions,
+                           const std::vector<glm::vec2> &_textureCoordinates,
+                           const std::vector<glm::vec4> &_normals,
+                           const std::vector<uint32_t> &indices) :
+    positions(_positions), textureCoordinates(_textureCoordinates) {
+
+    this->normals.reserve(_normals.size());
+    for (const glm::vec4 &normal : _normals) {
+        this->normals.push_back(glm::vec3(normal));
+    }
 
-                this->faces.push_back(TriangleFace(p1, p2, p3));
-                completeFaces = std::make_optional<bool>(true);
-            } else if (match.str(13).length() > 0) {
-                const int p1 = std::stoi(match.str(13)) - 1;
-                const int t1 = std::stoi(match.str(14)) - 1;
-                const int n1 = std::stoi(match.str(15)) - 1;
+    // Every attribute of a vertex has the same index
+    this->faces.reserve(indices.size() / 3);
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        const int32_t v0 = indices[i], v1 = indices[i + 1], v2 = indices[i + 2];
+        this->faces.push_back(TriangleFace(v0, v0, v0, v1, v1, v1, v2, v2, v2));
+    }
+}
 
-                const int p2 = std::stoi(match.str(16)) - 1;
-                const int t2 = std::stoi(match.str(17)) - 1;
-                const int n2 = std::stoi(match.str(18)) - 1;
+void WavefrontOBJ::writeToFile(const std::string &filename, int precision) const {
+    std::ofstream file;
+    file.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+    file.open(filename, std::ios::out | std::ios::trunc | std::ios::binary);
 
-                const int p3 = std::stoi(match.str(19)) - 1;
-                const int t3 = std::stoi(match.str(20)) - 1;
-                const int n3 = std::stoi(match.str(21)) - 1;
+    // More digits than needed to represent any float exactly would only make the file larger
+    precision = std::min(precision, std::numeric_limits<float>::max_digits10);
 
-                this->faces.push_back(TriangleFace(p1, t1, n1, p2, t2, n2, p3, t3, n3));
+    if (this->comment.length() > 0)
+        file << "# " << this->comment << "\n";
+
+    // Sections are formatted in blocks, in parallel, and written in order as soon as possible. The
+    // number of blocks in flight is limited, so that memory usage doesn't grow with the model.
+    const size_t blockSize = 65536;
+    const unsigned int threads = std::max(std::thread::hardware_concurrency(), 1u);
+    const std::launch policy = threads > 1 ? std::launch::async : std::launch::deferred;
+    std::deque<std::future<std::string>> blocks;
+
+    const auto writeBlock = [&file, &blocks]() {
+        const std::string block = blocks.front().get();
+        file.write(block.data(), block.size());
+        blocks.pop_front();
+    };
+
+    const auto writeSection = [&](size_t count, auto formatElement) {
+        for (size_t begin = 0; begin < count; begin += blockSize) {
+            if (blocks.size() >= 2 * threads) {
+                writeBlock();
             }
-        } else {
-            throw std::runtime_error("Failed to parse OBJ file " + filename + ": line " +
-                                     std::to_string(lineNumber));
+
+            const size_t end = std::min(begin + blockSize, count);
+            blocks.push_back(std::async(policy, [begin, end, formatElement]() {
+                std::string block;
+                block.reserve((end - begin) * 48);
+                for (size_t i = begin; i < end; ++i) {
+                    formatElement(block, i);
+                }
+                return block;
+            }));
         }
+    };
+
+    writeSection(this->positions.size(), [this, precision](std::string &block, size_t i) {
+        const glm::vec4 &v = this->positions[i];
+        block += "v ";
+        WavefrontOBJ::formatFloat(block, v.x, precision);
+        block += ' ';
+        WavefrontOBJ::formatFloat(block, v.y, precision);
+        block += ' ';
+        WavefrontOBJ::formatFloat(block, v.z, precision);
+        if (v.w != 1.0f) {
+            block += ' ';
+            WavefrontOBJ::formatFloat(block, v.w, precision);
+        }
+        block += '\n';
+    });
+
+    writeSection(this->textureCoordinates.size(), [this, precision](std::string &block, size_t i) {
+        const glm::vec2 &v = this->textureCoordinates[i];
+        block += "vt ";
+        WavefrontOBJ::formatFloat(block, v.x, precision);
+        block += ' ';
+        WavefrontOBJ::formatFloat(block, v.y, precision);
+        block += '\n';
+    });
+
+    writeSection(this->normals.size(), [this, precision](std::string &block, size_t i) {
+        const glm::vec3 &v = this->normals[i];
+        block += "vn ";
+        WavefrontOBJ::formatFloat(block, v.x, precision);
+        block += ' ';
+        WavefrontOBJ::formatFloat(block, v.y, precision);
+        block += ' ';
+        WavefrontOBJ::formatFloat(block, v.z, precision);
+        block += '\n';
+    });
+
+    writeSection(this->faces.size(), [this](std::string &block, size_t i) {
+        const TriangleFace &f = this->faces[i];
+        block += 'f';
+        for (int j = 0; j < 3; ++j) {
+            block += ' ';
+            WavefrontOBJ::formatIndex(block, f.positions[j]);
+
+            if (f.textureCoordinates[0] != -1) {
+                block += '/';
+                WavefrontOBJ::formatIndex(block, f.textureCoordinates[j]);
+                block += '/';
+                WavefrontOBJ::formatIndex(block, f.normals[j]);
+            }
+        }
+        block += '\n';
+    });
 
-        lineNumber++;
+    while (!blocks.empty()) {
+        writeBlock();
     }
+}
 
-    if (file.bad()) {
-        throw std::ios_base::failure("Error while reading from OBJ file: " + filename);
-    }
+std::tuple<std::vector<glm::vec4>,
+           std::vector<glm::vec2>,
+           std::vector<glm::vec4>,
+           std::vector<uint32_t>>
+    WavefrontOBJ::getIndexedVertices() const {
+
+    // Vertices are identified by their index triple, in an open addressing hash table with linear
+    // probing. Closed meshes have about half as many vertices as faces, so a table with as many
+    // slots as faces usually never needs to grow.
+    struct VertexSlot {
+        int32_t position, textureCoordinate, normal;
+        uint32_t bufferIndex;
+    };
+
+    const auto hashVertex = [](int32_t position, int32_t textureCoordinate, int32_t normal) {
+        uint64_t hash = static_cast<uint32_t>(position) * 0x9e3779b97f4a7c15;
+        hash ^= static_cast<uint32_t>(textureCoordinate) * 0xc2b2ae3d27d4eb4f;
+        hash ^= static_cast<uint32_t>(normal) * 0x165667b19e3779f9;
+        return hash ^ (hash >> 32);
+    };
+
+    size_t tableSize = std::bit_ceil(std::max<size_t>(this->faces.size(), 16));
+    std::vector<VertexSlot> table(tableSize, VertexSlot { -1, -1, -1, 0 });
+
+    std::vector<glm::vec4> bufferPositions;
+    std::vector<glm::vec2> bufferTextureCoordinates;
+    std::vector<glm::vec4> bufferNormals;
+    std::vector<uint32_t> indices;
+
+    bufferPositions.reserve(this->positions.size());
+    bufferTextureCoordinates.reserve(this->positions.size());
+    bufferNormals.reserve(this->positions.size());
+    indices.reserve(this->faces.size() * 3);
 
     for (const TriangleFace &face : this->faces) {
-        if (std::any_of(face.positions.cbegin(),
-                        face.positions.cend(),
-                        [this](const int32_t &positionIndex) {
-                            return positionIndex >= static_cast<int32_t>(this->positions.size());
-                        })) {
-            throw std::runtime_error("Invalid position indices in OBJ file: " + filename);
-        }
+        for (int i = 0; i < 3; ++i) {
+            // Faces without texture coordinates use generated normals, indexed by position
+            const int32_t position = face.positions[i];
+            const int32_t textureCoordinate = face.textureCoordinates[i];
+            const int32_t normal = textureCoordinate >= 0 ? face.normals[i] : position;
+
+            size_t slot = hashVertex(position, textureCoordinate, normal) & (tableSize - 1);
+            while (table[slot].position != -1 &&
+                   (table[slot].position != position ||
+                    table[slot].textureCoordinate != textureCoordinate ||
+                    table[slot].normal != normal)) {
+
+                slot = (slot + 1) & (tableSize - 1);
+            }
 
-        if (std::any_of(face.textureCoordinates.cbegin(),
-                        face.textureCoordinates.cend(),
-                        [this](const int32_t &textureCoordinateIndex) {
-                            return textureCoordinateIndex >=
-                                static_cast<int32_t>(this->textureCoordinates.size());
-                        })) {
-            throw std::runtime_error("Invalid texture coordinate indices in OBJ file: " + filename);
+            if (table[slot].position == -1) {
+                bufferPositions.push_back(this->positions[position]);
+                bufferTextureCoordinates.push_back(textureCoordinate >= 0
+                                                       ? this->textureCoordinates[textureCoordinate]
+                                                       : glm::vec2(0.0f, 0.0f));
+                bufferNormals.push_back(glm::vec4(this->normals[normal], 0.0f));
+
+                const uint32_t bufferIndex = bufferPositions.size() - 1;
+                table[slot] = { position, textureCoordinate, normal, bufferIndex };
+                indices.push_back(bufferIndex);
+
+                // Keep the load factor under 1/2
+                if (bufferPositions.size() * 2 > tableSize) {
+                    tableSize *= 2;
+                    std::vector<VertexSlot> newTable(tableSize, VertexSlot { -1, -1, -1, 0 });
+
+                    for (const VertexSlot &vertex : table) {
+                        if (vertex.position != -1) {
+                            size_t newSlot = hashVertex(vertex.position,
+                                                        vertex.textureCoordinate,
+                                                        vertex.normal) &
+                                (tableSize - 1);
+
+                            while (newTable[newSlot].position != -1) {
+                                newSlot = (newSlot + 1) & (tableSize - 1);
+                            }
+                            newTable[newSlot] = vertex;
+                        }
+                    }
+
+                    table = std::move(newTable);
+                }
+            } else {
+                indices.push_back(table[slot].bufferIndex);
+            }
         }
+    }
+
+    return std::make_tuple(std::move(bufferPositions),
+                           std::move(bufferTextureCoordinates),
+                           std::move(bufferNormals),
+                           std::move(indices));
+}
 
-        if (std::any_of(face.normals.cbegin(),
-                        face.normals.cend(),
-                        [this](const int32_t &normalIndex) {
-                            return normalIndex >= static_cast<int32_t>(this->normals.size());
-                        })) {
-            throw std::runtime_error("Invalid normal indices in OBJ file: " + filename);
+void WavefrontOBJ::generateNormals() {
+    // Each thread sums the normals of a range of faces into its own array. Normals are weighted by
+    // triangle area, and the length of the cross product is already proportional to it.
+    const size_t facesPerThread = 65536;
+    const size_t threads =
+        std::clamp<size_t>(this->faces.size() / facesPerThread,
+                           1,
+                           std::max(std::thread::hardware_concurrency(), 1u));
+    const std::launch policy = threads > 1 ? std::launch::async : std::launch::deferred;
+
+    const auto sumNormals = [this](size_t begin, size_t end) {
+        std::vector<glm::vec3> sums(this->positions.size(), glm::vec3(0.0f));
+
+        for (size_t i = begin; i < end; ++i) {
+            const TriangleFace &face = this->faces[i];
+            const glm::vec3 p0 = glm::vec3(this->positions[face.positions[0]]);
+            const glm::vec3 p1 = glm::vec3(this->positions[face.positions[1]]);
+            const glm::vec3 p2 = glm::vec3(this->positions[face.positions[2]]);
+
+            const glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+            for (int32_t position : face.positions) {
+                sums[position] += normal;
+            }
         }
+
+        return sums;
+    };
+
+    std::vector<std::future<std::vector<glm::vec3>>> summingTasks;
+    for (size_t i = 0; i < threads; ++i) {
+        summingTasks.push_back(std::async(policy,
+                                          sumNormals,
+                                          this->faces.size() * i / threads,
+                                          this->faces.size() * (i + 1) / threads));
     }
 
-    for (const TriangleFace &face : this->faces) {
-        if (std::any_of(
-                face.textureCoordinates.cbegin(),
-                face.textureCoordinates.cend(),
-                [](const int32_t &textureCoordinateIndex) { return textureCoordinateIndex < 0; })) {
+    std::vector<std::vector<glm::vec3>> partialSums;
+    for (std::future<std::vector<glm::vec3>> &task : summingTasks) {
+        partialSums.push_back(task.get());
+    }
 
-            this->generateNormals();
-            break;
+    // Add the partial sums of each vertex and normalize them, also in parallel
+    this->normals = std::move(partialSums.front());
+
+    const auto addNormals = [this, &partialSums](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            for (size_t j = 1; j < partialSums.size(); ++j) {
+                this->normals[i] += partialSums[j][i];
+            }
+
+            // Normals of opposite faces (e.g.: double-sided surfaces) may cancel each other out
+            const float length = glm::length(this->normals[i]);
+            if (length > 0.0f) {
+                this->normals[i] /= length;
+            }
         }
+    };
+
+    std::vector<std::future<void>> addingTasks;
+    for (size_t i = 0; i < threads; ++i) {
+        addingTasks.push_back(std::async(policy,
+                                         addNormals,
+                                         this->normals.size() * i / threads,
+                                         this->normals.size() * (i + 1) / threads));
+    }
+
+    for (std::future<void> &task : addingTasks) {
+        task.get();
     }
 }
 
-void WavefrontOBJ::writeToFile(const std::string &filename) const {
-    std::ofstream file;
-    file.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-    file.open(filename, std::ios::out | std::ios::trunc);
+WavefrontOBJ::ParseStatistics WavefrontOBJ::parseLines(const char *begin, const char *end) {
+    ParseStatistics statistics = { 0, false, -1, -1, -1, false, false };
+    const char *line = begin;
 
-    if (this->comment.length() > 0)
-        file << "# " << this->comment << std::endl;
+    while (line < end) {
+        const char *lineEnd = static_cast<const char *>(std::memchr(line, '\n', end - line));
+        if (!lineEnd) {
+            lineEnd = end;
+        }
 
-    for (const glm::vec4 &v : this->positions) {
-        file << "v " << v.x << " " << v.y << " " << v.z;
-        if (v.w != 1.0f)
-            file << " " << v.w;
+        if (!this->parseLine(line, lineEnd, statistics)) {
+            statistics.failed = true;
+            break;
+        }
 
-        file << std::endl;
+        line = lineEnd == end ? end : lineEnd + 1;
+        statistics.lineCount++;
     }
 
-    for (const glm::vec2 &v : this->textureCoordinates) {
-        file << "vt " << v.x << " " << v.y << std::endl;
+    return statistics;
+}
+
+WavefrontOBJ::ParseStatistics
+    WavefrontOBJ::parseLinesInParallel(const char *begin, const char *end, unsigned int threads) {
+
+    // Split the file into chunks, each starting at the beginning of a line
+    std::vector<const char *> boundaries = { begin };
+    for (unsigned int i = 1; i < threads; ++i) {
+        const char *const split = std::max(begin + (end - begin) * i / threads, boundaries.back());
+        const char *const newline =
+            static_cast<const char *>(std::memchr(split, '\n', end - split));
+        boundaries.push_back(newline ? newline + 1 : end);
+    }
+    boundaries.push_back(end);
+
+    // Parse each chunk into its own object
+    const auto parseChunk = [](const char *chunkBegin, const char *chunkEnd) {
+        WavefrontOBJ chunk;
+        const ParseStatistics chunkStatistics = chunk.parseLines(chunkBegin, chunkEnd);
+        return std::make_pair(std::move(chunk), chunkStatistics);
+    };
+
+    std::vector<std::future<std::pair<WavefrontOBJ, ParseStatistics>>> parsingTasks;
+    for (unsigned int i = 0; i < threads; ++i) {
+        parsingTasks.push_back(
+            std::async(std::launch::async, parseChunk, boundaries[i], boundaries[i + 1]));
     }
 
-    for (const glm::vec3 &v : this->normals) {
-        file << "vn " << v.x << " " << v.y << " " << v.z << std::endl;
+    std::vector<std::pair<WavefrontOBJ, ParseStatistics>> chunks;
+    for (std::future<std::pair<WavefrontOBJ, ParseStatistics>> &task : parsingTasks) {
+        chunks.push_back(task.get());
     }
 
-    for (const TriangleFace &f : this->faces) {
-        // 0-based index to 1-based index
-        if (f.textureCoordinates[0] == -1) {
-            file << "f ";
-            file << f.positions[0] + 1 << " ";
-            file << f.positions[1] + 1 << " ";
-            file << f.positions[2] + 1 << std::endl;
-        } else {
-            file << "f ";
+    // Merge statistics, stopping at the first chunk with an error, whose line must be reported
+    ParseStatistics statistics = { 0, false, -1, -1, -1, false, false };
+    for (const auto &[chunk, chunkStatistics] : chunks) {
+        statistics.lineCount += chunkStatistics.lineCount;
+        if (chunkStatistics.failed) {
+            statistics.failed = true;
+            return statistics;
+        }
+
+        statistics.maxPosition = std::max(statistics.maxPosition, chunkStatistics.maxPosition);
+        statistics.maxTextureCoordinate =
+            std::max(statistics.maxTextureCoordinate, chunkStatistics.maxTextureCoordinate);
+        statistics.maxNormal = std::max(statistics.maxNormal, chunkStatistics.maxNormal);
+        statistics.hasNormals |= chunkStatistics.hasNormals;
+        statistics.hasSimpleFaces |= chunkStatistics.hasSimpleFaces;
+    }
 
-            file << f.positions[0] + 1 << "/";
-            file << f.textureCoordinates[0] + 1 << "/";
-            file << f.normals[0] + 1 << " ";
+    // Concatenate chunks in parallel. Indices in OBJ files are global, so they remain valid as long
+    // as chunk order is preserved.
+    std::vector<size_t> positionOffsets, textureCoordinateOffsets, normalOffsets, faceOffsets;
+    size_t positionCount = 0, textureCoordinateCount = 0, normalCount = 0, faceCount = 0;
+    for (const auto &[chunk, chunkStatistics] : chunks) {
+        positionOffsets.push_back(positionCount);
+        textureCoordinateOffsets.push_back(textureCoordinateCount);
+        normalOffsets.push_back(normalCount);
+        faceOffsets.push_back(faceCount);
+
+        positionCount += chunk.positions.size();
+        textureCoordinateCount += chunk.textureCoordinates.size();
+        normalCount += chunk.normals.size();
+        faceCount += chunk.faces.size();
+    }
 
-            file << f.positions[1] + 1 << "/";
-            file << f.textureCoordinates[1] + 1 << "/";
-            file << f.normals[1] + 1 << " ";
+    this->positions.resize(positionCount);
+    this->textureCoordinates.resize(textureCoordinateCount);
+    this->normals.resize(normalCount);
+    this->faces.resize(faceCount, TriangleFace(-1, -1, -1));
+
+    const auto copyChunk = [this](const WavefrontOBJ &chunk,
+                                  size_t positionOffset,
+                                  size_t textureCoordinateOffset,
+                                  size_t normalOffset,
+                                  size_t faceOffset) {
+        std::copy(chunk.positions.cbegin(),
+                  chunk.positions.cend(),
+                  this->positions.begin() + positionOffset);
+        std::copy(chunk.textureCoordinates.cbegin(),
+                  chunk.textureCoordinates.cend(),
+                  this->textureCoordinates.begin() + textureCoordinateOffset);
+        std::copy(chunk.normals.cbegin(),
+                  chunk.normals.cend(),
+                  this->normals.begin() + normalOffset);
+        std::copy(chunk.faces.cbegin(), chunk.faces.cend(), this->faces.begin() + faceOffset);
+    };
+
+    std::vector<std::future<void>> copyingTasks;
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        copyingTasks.push_back(std::async(std::launch::async,
+                                          copyChunk,
+                                          std::cref(chunks[i].first),
+                                          positionOffsets[i],
+                                          textureCoordinateOffsets[i],
+                                          normalOffsets[i],
+                                          faceOffsets[i]));
+    }
 
-            file << f.positions[2] + 1 << "/";
-            file << f.textureCoordinates[2] + 1 << "/";
-            file << f.normals[2] + 1 << std::endl;
-        }
+    for (std::future<void> &task : copyingTasks) {
+        task.get();
     }
+
+    return statistics;
 }
 
-std::tuple<std::vector<glm::vec4>,
-           std::vector<glm::vec2>,
-           std::vector<glm::vec4>,
-           std::vector<uint32_t>>
-    WavefrontOBJ::getIndexedVertices() const {
+bool WavefrontOBJ::parseLine(const char *line, const char *end, ParseStatistics &statistics) {
+    const char *cursor = line;
+
+    if (cursor == end) {
+        return true;
+    } else if (*cursor == '#') {
+        return true;
+    } else if (*cursor == 'v') {
+        cursor++;
+        if (cursor < end && *cursor == 't') {
+            cursor++;
+
+            glm::vec2 textureCoordinate;
+            if (!(WavefrontOBJ::skipWhitespace(cursor, end) &&
+                  WavefrontOBJ::parseFloat(cursor, end, textureCoordinate.x) &&
+                  WavefrontOBJ::skipWhitespace(cursor, end) &&
+                  WavefrontOBJ::parseFloat(cursor, end, textureCoordinate.y))) {
+                return false;
+            }
 
-    std::unordered_map<std::tuple<glm::vec4, glm::vec2, glm::vec3>, int32_t> addedVertices;
-    std::vector<glm::vec4> bufferPositions;
-    std::vector<glm::vec2> bufferTextureCoordinates;
-    std::vector<glm::vec4> bufferNormals;
-    std::vector<uint32_t> indices;
+            this->textureCoordinates.push_back(textureCoordinate);
+        } else if (cursor < end && *cursor == 'n') {
+            cursor++;
 
-    for (const TriangleFace &face : faces) {
-        for (int i = 0; i < 3; ++i) {
-            const glm::vec4 position = this->positions[face.positions[i]];
+            glm::vec3 normal;
+            if (!(WavefrontOBJ::skipWhitespace(cursor, end) &&
+                  WavefrontOBJ::parseFloat(cursor, end, normal.x) &&
+                  WavefrontOBJ::skipWhitespace(cursor, end) &&
+                  WavefrontOBJ::parseFloat(cursor, end, normal.y) &&
+                  WavefrontOBJ::skipWhitespace(cursor, end) &&
+                  WavefrontOBJ::parseFloat(cursor, end, normal.z))) {
+                return false;
+            }
 
-            glm::vec2 textureCoordinate = glm::vec2(0.0f, 0.0f);
-            if (face.textureCoordinates[i] >= 0) {
-                textureCoordinate = this->textureCoordinates[face.textureCoordinates[i]];
+            this->normals.push_back(normal);
+            statistics.hasNormals = true;
+        } else {
+            glm::vec4 position(0.0f, 0.0f, 0.0f, 1.0f);
+            if (!(WavefrontOBJ::skipWhitespace(cursor, end) &&
+                  WavefrontOBJ::parseFloat(cursor, end, position.x) &&
+                  WavefrontOBJ::skipWhitespace(cursor, end) &&
+                  WavefrontOBJ::parseFloat(cursor, end, position.y) &&
+                  WavefrontOBJ::skipWhitespace(cursor, end) &&
+                  WavefrontOBJ::parseFloat(cursor, end, position.z))) {
+                return false;
             }
 
-            glm::vec3 normal;
-            if (face.textureCoordinates[i] >= 0) {
-                normal = this->normals[face.normals[i]];
-            } else {
-                normal = this->normals[face.positions[i]];
+            // Optional w coordinate
+            if (WavefrontOBJ::skipWhitespace(cursor, end) && cursor < end) {
+                if (!WavefrontOBJ::parseFloat(cursor, end, position.w)) {
+                    return false;
+                }
             }
 
-            const std::tuple<glm::vec4, glm::vec2, glm::vec3> key =
-                std::make_tuple(position, textureCoordinate, normal);
-            auto it = addedVertices.find(key);
+            this->positions.push_back(position);
+        }
+    } else if (*cursor == 'f') {
+        cursor++;
 
-            uint32_t bufferIndex;
-            if (it == addedVertices.end()) {
-                bufferPositions.push_back(position);
-                bufferTextureCoordinates.push_back(textureCoordinate);
-                bufferNormals.push_back(glm::vec4(normal, 0.0f));
+        int32_t p[3], t[3], n[3];
+        if (!(WavefrontOBJ::skipWhitespace(cursor, end) &&
+              WavefrontOBJ::parseIndex(cursor, end, p[0]))) {
+            return false;
+        }
 
-                bufferIndex = bufferPositions.size() - 1;
-                addedVertices[key] = bufferIndex;
-            } else {
-                bufferIndex = it->second;
+        if (cursor < end && *cursor == '/') {
+            for (int i = 0; i < 3; ++i) {
+                if (i > 0 &&
+                    !(WavefrontOBJ::skipWhitespace(cursor, end) &&
+                      WavefrontOBJ::parseIndex(cursor, end, p[i]))) {
+                    return false;
+                }
+
+                if (!(cursor < end && *cursor++ == '/' &&
+                      WavefrontOBJ::parseIndex(cursor, end, t[i]) && cursor < end &&
+                      *cursor++ == '/' && WavefrontOBJ::parseIndex(cursor, end, n[i]))) {
+                    return false;
+                }
             }
 
-            indices.push_back(bufferIndex);
+            statistics.maxTextureCoordinate =
+                std::max({ statistics.maxTextureCoordinate, t[0], t[1], t[2] });
+            statistics.maxNormal = std::max({ statistics.maxNormal, n[0], n[1], n[2] });
+            this->faces.push_back(
+                TriangleFace(p[0], t[0], n[0], p[1], t[1], n[1], p[2], t[2], n[2]));
+        } else {
+            if (!(WavefrontOBJ::skipWhitespace(cursor, end) &&
+                  WavefrontOBJ::parseIndex(cursor, end, p[1]) &&
+                  WavefrontOBJ::skipWhitespace(cursor, end) &&
+                  WavefrontOBJ::parseIndex(cursor, end, p[2]))) {
+                return false;
+            }
+
+            this->faces.push_back(TriangleFace(p[0], p[1], p[2]));
+            statistics.hasSimpleFaces = true;
         }
+
+        statistics.maxPosition = std::max({ statistics.maxPosition, p[0], p[1], p[2] });
     }
 
-    return std::make_tuple(bufferPositions, bufferTextureCoordinates, bufferNormals, indices);
+    // Lines may only be followed by whitespace (or be made only of it)
+    WavefrontOBJ::skipWhitespace(cursor, end);
+    return cursor == end;
 }
 
-void WavefrontOBJ::generateNormals() {
-    std::unordered_map<glm::vec4, glm::vec3> averageNormals;
+bool WavefrontOBJ::skipWhitespace(const char *&cursor, const char *end) {
+    const char *const start = cursor;
+    while (cursor < end && (*cursor == ' ' || (*cursor >= '\t' && *cursor <= '\r'))) {
+        cursor++;
+    }
+    return cursor != start;
+}
 
-    for (const TriangleFace &face : this->faces) {
-        // Get points and sides of the triangle
-        const glm::vec4 p0 = this->positions[face.positions[0]];
-        const glm::vec4 p1 = this->positions[face.positions[1]];
-        const glm::vec4 p2 = this->positions[face.positions[2]];
-
-        const glm::vec3 v0 = glm::vec3(p1) - glm::vec3(p0);
-        const glm::vec3 v1 = glm::vec3(p2) - glm::vec3(p0);
-        const glm::vec3 v2 = glm::vec3(p2) - glm::vec3(p1);
-
-        // Calculate area of triangle via Heron's formula
-        const float sideLength0 = glm::length(v0);
-        const float sideLength1 = glm::length(v1);
-        const float sideLength2 = glm::length(v2);
-        const float semiPerimeter = 0.5f * (sideLength0 + sideLength1 + sideLength2);
-        const float area = sqrtf(semiPerimeter * (semiPerimeter - sideLength0) *
-                                 (semiPerimeter - sideLength1) * (semiPerimeter - sideLength2));
-
-        // Calculate weighted average
-        const glm::vec3 normal = glm::normalize(glm::cross(v0, v1)) * area;
-        averageNormals[p0] += normal;
-        averageNormals[p1] += normal;
-        averageNormals[p2] += normal;
+bool WavefrontOBJ::parseFloat(const char *&cursor, const char *end, float &value) {
+    // Validate [+-]?[0-9]+(\.[0-9]+)?(e[+-]?[0-9]+)? before converting, as std::from_chars is
+    // more permissive (accepts, for example, "inf", "1." and "1E5")
+    const char *const start = cursor;
+    const auto skipDigits = [&cursor, end]() {
+        const char *const digitsStart = cursor;
+        while (cursor < end && *cursor >= '0' && *cursor <= '9') {
+            cursor++;
+        }
+        return cursor != digitsStart;
+    };
+
+    if (cursor < end && (*cursor == '+' || *cursor == '-')) {
+        cursor++;
     }
 
-    for (const glm::vec4 &position : this->positions) {
-        const glm::vec3 perpendicular = averageNormals[position];
-        this->normals.push_back(glm::normalize(perpendicular));
+    if (!skipDigits()) {
+        return false;
     }
+
+    if (cursor < end && *cursor == '.') {
+        cursor++;
+        if (!skipDigits()) {
+            return false;
+        }
+    }
+
+    if (cursor < end && *cursor == 'e') {
+        cursor++;
+        if (cursor < end && (*cursor == '+' || *cursor == '-')) {
+            cursor++;
+        }
+
+        if (!skipDigits()) {
+            return false;
+        }
+    }
+
+    // std::from_chars doesn't accept a leading plus sign
+    const char *const number = *start == '+' ? start + 1 : start;
+    const std::from_chars_result result = std::from_chars(number, cursor, value);
+    return result.ec == std::errc() && result.ptr == cursor;
+}
+
+bool WavefrontOBJ::parseIndex(const char *&cursor, const char *end, int32_t &index) {
+    // Indices in OBJ files start at 1. Relative (negative) and zero indices are rejected by the
+    // bounds check, like they were by the old grammar.
+    const std::from_chars_result result = std::from_chars(cursor, end, index);
+    if (result.ec != std::errc() || index < 1) {
+        return false;
+    }
+
+    cursor = result.ptr;
+    index--;
+    return true;
+}
+
+void WavefrontOBJ::formatFloat(std::string &buffer, float value, int precision) {
+    char number[64];
+    char *const end =
+        std::to_chars(number, number + sizeof(number), value, std::chars_format::general, precision)
+            .ptr;
+    buffer.append(number, end);
 }
 
-// clang-format off
-std::regex WavefrontOBJ::lineRegex(
-    "\\s*"
-    "|"
-    "#.*"
-    "|"
-    "v\\s+" "((?:-|\\+)?[0-9]+(?:\\.[0-9]+)?(?:e(?:-|\\+)?[0-9]+)?)\\s+"
-            "((?:-|\\+)?[0-9]+(?:\\.[0-9]+)?(?:e(?:-|\\+)?[0-9]+)?)\\s+"
-            "((?:-|\\+)?[0-9]+(?:\\.[0-9]+)?(?:e(?:-|\\+)?[0-9]+)?)"
-            "(\\s+(?:-|\\+)?[0-9]+(?:\\.[0-9]+)?(?:e[0-9]+)?)?\\s*"
-    "|"
-    "vt\\s+" "((?:-|\\+)?[0-9]+(?:\\.[0-9]+)?(?:e(?:-|\\+)?[0-9]+)?)\\s+"
-             "((?:-|\\+)?[0-9]+(?:\\.[0-9]+)?(?:e(?:-|\\+)?[0-9]+)?)\\s*"
-    "|"
-    "vn\\s+" "((?:-|\\+)?[0-9]+(?:\\.[0-9]+)?(?:e(?:-|\\+)?[0-9]+)?)\\s+"
-             "((?:-|\\+)?[0-9]+(?:\\.[0-9]+)?(?:e(?:-|\\+)?[0-9]+)?)\\s+"
-             "((?:-|\\+)?[0-9]+(?:\\.[0-9]+)?(?:e(?:-|\\+)?[0-9]+)?)\\s*"
-    "|"
-    "f\\s+([0-9]+)\\s+([0-9]+)\\s+([0-9]+)\\s*"
-    "|"
-    "f\\s+([0-9]+)/([0-9]+)/([0-9]+)\\s+([0-9]+)/([0-9]+)/([0-9]+)\\s+([0-9]+)/([0-9]+)/([0-9]+)\\s*",
-    std::regex_constants::ECMAScript);
-// clang-format on
+void WavefrontOBJ::formatIndex(std::string &buffer, int32_t index) {
+    // 0-based index to 1-based index
+    char number[16];
+    char *const end = std::to_chars(number, number + sizeof(number), index + 1).ptr;
+    buffer.append(number, end);
+}
 
 }